@@ -0,0 +1,27 @@
+#ifndef batch_conversion_h
+#define batch_conversion_h
+
+// C++ standard headers
+#include <cstddef>
+#include <cstdint>
+
+// Conversions of arrays of values, used by the batch conversions of the tick types.
+//
+// On x86 with GCC or Clang the implementation is selected at run time, using the AVX-512 or AVX2
+// instructions if the processor supports them, with an ifunc where available (like
+// serialising_rdtsc), and falling back to a portable scalar loop otherwise.
+
+// out[i] = round(in[i] * factor / 2^32), with the same results as the scalar conversions of the
+// tick types, i.e. a 128-bit product rounded half up and truncated to 64 bits
+void batch_multiply_shifted(const int64_t * in, int64_t * out, size_t size, uint64_t factor) noexcept;
+
+// out[i] = in[i] * factor
+void batch_multiply(const double * in, double * out, size_t size, double factor) noexcept;
+
+// out[i] = in[i] / divisor
+void batch_divide(const double * in, double * out, size_t size, double divisor) noexcept;
+
+// name of the implementation selected at run time: "AVX-512", "AVX2" or "scalar"
+const char * batch_conversion_kernel() noexcept;
+
+#endif // batch_conversion_h
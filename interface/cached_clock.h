@@ -0,0 +1,162 @@
+#ifndef cached_clock_h
+#define cached_clock_h
+
+// C++ standard headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// A clock that returns the value of the Source clock cached by a background thread.
+//
+// The ticker thread reads the Source every interval (1 ms by default) and stores the value in an
+// atomic on its own cache line, so now() is a single relaxed load that never calls into the kernel,
+// and the readers on other cores only miss the cache when the value changes. The value is at most
+// one interval plus the wake-up latency of the ticker old: staleness() reports the largest gap
+// measured between two updates since the ticker was started.
+//
+// The time points are those of the Source, so they can be compared with the values of
+// Source::now(). Until start() is called, now() returns the epoch of the Source; after stop(), it
+// keeps returning the last value read.
+template <typename Source>
+struct clock_cached : private Source
+{
+  typedef typename Source::duration                                     duration;
+  typedef typename Source::rep                                          rep;
+  typedef typename Source::period                                       period;
+  typedef typename Source::time_point                                   time_point;
+
+  // the properties of the Source itself, rather than copies: they are constant expressions if they
+  // are in the Source, and are correct even if they are only set by a dynamic initialiser in another
+  // translation unit, which a copy could read before it runs
+  using Source::is_steady;
+  using Source::is_available;
+
+  static time_point now() noexcept
+  {
+    return time_point(duration(cache.value.load(std::memory_order_relaxed)));
+  }
+
+  // start the ticker thread, or change its interval from the next update if it is already running;
+  // the cached value is valid when this returns
+  static void start(std::chrono::nanoseconds interval = std::chrono::milliseconds(1))
+  {
+    ticker_state & t = ticker();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.interval = interval;
+    if (t.thread.joinable())
+      return;
+    refresh();
+    t.max_gap.store(0, std::memory_order_relaxed);
+    t.stop = false;
+    t.thread = std::thread(tick);
+  }
+
+  // stop the ticker thread, if it is running
+  static void stop()
+  {
+    ticker().join();
+  }
+
+  static bool is_running()
+  {
+    ticker_state & t = ticker();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return t.thread.joinable();
+  }
+
+  // the interval between two updates requested by start()
+  static std::chrono::nanoseconds interval()
+  {
+    ticker_state & t = ticker();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    return t.interval;
+  }
+
+  // the largest gap measured between two updates since the ticker was started, i.e. how old the
+  // value returned by now() has been so far
+  static std::chrono::nanoseconds staleness() noexcept
+  {
+    return std::chrono::nanoseconds(ticker().max_gap.load(std::memory_order_relaxed));
+  }
+
+private:
+  // the cached value, alone on its cache line
+  struct alignas(64) cache_line {
+    std::atomic<rep> value;
+  };
+
+  struct ticker_state {
+    std::mutex               mutex;
+    std::condition_variable  wakeup;
+    std::thread              thread;
+    std::chrono::nanoseconds interval = std::chrono::milliseconds(1);
+    std::atomic<int64_t>     max_gap;
+    bool                     stop = false;
+
+    void join()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!thread.joinable())
+          return;
+        stop = true;
+      }
+      wakeup.notify_all();
+      thread.join();
+    }
+
+    ~ticker_state()
+    {
+      join();
+    }
+  };
+
+  static ticker_state & ticker()
+  {
+    static ticker_state instance;
+    return instance;
+  }
+
+  static void refresh() noexcept
+  {
+    cache.value.store(Source::now().time_since_epoch().count(), std::memory_order_relaxed);
+  }
+
+  // refresh the cached value at a fixed rate, measuring the gaps between the updates
+  static void tick()
+  {
+    ticker_state & t = ticker();
+    auto last = std::chrono::steady_clock::now();
+    auto next = last;
+
+    std::unique_lock<std::mutex> lock(t.mutex);
+    while (true) {
+      next += t.interval;
+      t.wakeup.wait_until(lock, next, [&t] { return t.stop; });
+      if (t.stop)
+        break;
+
+      refresh();
+      auto current = std::chrono::steady_clock::now();
+      int64_t gap = std::chrono::duration_cast<std::chrono::nanoseconds>(current - last).count();
+      if (gap > t.max_gap.load(std::memory_order_relaxed))
+        t.max_gap.store(gap, std::memory_order_relaxed);
+      last = current;
+
+      // do not try to catch up after a long delay, e.g. a suspend
+      next = std::max(next, current);
+    }
+  }
+
+  // zero-initialised, so now() returns the epoch of the Source until the ticker is started
+  static cache_line cache;
+};
+
+template <typename Source>
+typename clock_cached<Source>::cache_line clock_cached<Source>::cache;
+
+#endif // cached_clock_h
@@ -0,0 +1,47 @@
+#ifndef duration_rounding_h
+#define duration_rounding_h
+
+// rounding of the conversions from native ticks to integer durations, matching the standard casts
+enum class duration_rounding {
+  toward_zero,          // std::chrono::duration_cast
+  floor,                // std::chrono::floor, toward negative infinity
+  ceil,                 // std::chrono::ceil, toward positive infinity
+  nearest               // std::chrono::round, to the nearest value and the ties to even
+};
+
+// divide by a positive divisor, with the given rounding; with a constant divisor, the compiler
+// replaces the division with a multiply
+template <typename T>
+inline T rounded_divide(T dividend, T divisor, duration_rounding mode) noexcept
+{
+  T quotient  = dividend / divisor;
+  T remainder = dividend % divisor;
+  switch (mode) {
+    case duration_rounding::toward_zero:
+      break;
+    case duration_rounding::floor:
+      if (remainder < 0)
+        quotient -= 1;
+      break;
+    case duration_rounding::ceil:
+      if (remainder > 0)
+        quotient += 1;
+      break;
+    case duration_rounding::nearest:
+      // compare the remainder with the rest of the divisor rather than doubling it, so it cannot
+      // overflow; the ties go to the even quotient
+      if (remainder > 0) {
+        T rest = divisor - remainder;
+        if (remainder > rest || (remainder == rest && (quotient & 1) != 0))
+          quotient += 1;
+      } else if (remainder < 0) {
+        T rest = divisor + remainder;
+        if (-remainder > rest || (-remainder == rest && (quotient & 1) != 0))
+          quotient -= 1;
+      }
+      break;
+  }
+  return quotient;
+}
+
+#endif // duration_rounding_h
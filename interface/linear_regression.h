@@ -0,0 +1,56 @@
+#ifndef linear_regression_h
+#define linear_regression_h
+
+// C++ standard headers
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Online least squares fit of y = intercept + slope * x.
+//
+// The sums are updated with Welford's method, which stays accurate when the samples are far from
+// the origin or when the fit is extended over a very large number of samples.
+struct linear_regression {
+  size_t n      = 0;
+  double mean_x = 0.;
+  double mean_y = 0.;
+  double m2_x   = 0.;           // sum of (x - mean_x)^2
+  double m2_y   = 0.;           // sum of (y - mean_y)^2
+  double c_xy   = 0.;           // sum of (x - mean_x) * (y - mean_y)
+
+  void add(double x, double y)
+  {
+    ++n;
+    double dx = x - mean_x;
+    double dy = y - mean_y;
+    mean_x += dx / n;
+    mean_y += dy / n;
+    m2_x   += dx * (x - mean_x);
+    m2_y   += dy * (y - mean_y);
+    c_xy   += dx * (y - mean_y);
+  }
+
+  double slope() const
+  {
+    return c_xy / m2_x;
+  }
+
+  double intercept() const
+  {
+    return mean_y - slope() * mean_x;
+  }
+
+  // standard error of the slope, or NaN if there are too few samples to estimate it
+  double slope_error() const
+  {
+    if (n < 3 || m2_x <= 0.)
+      return std::numeric_limits<double>::quiet_NaN();
+    // sum of the squared residuals
+    double ssr = m2_y - c_xy * c_xy / m2_x;
+    if (ssr < 0.)
+      ssr = 0.;
+    return std::sqrt(ssr / (n - 2) / m2_x);
+  }
+};
+
+#endif // linear_regression_h
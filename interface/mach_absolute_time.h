@@ -29,7 +29,7 @@ struct mach_absolute_time_clock
   static time_point now() noexcept
   {
     uint64_t   ticks  = mach_absolute_time();
-    rep        ns     = mach_absolute_time_tick::to_nanoseconds(ticks);
+    rep        ns     = mach_absolute_time_tick::to_timestamp(ticks);
     time_point time   = time_point(duration(ns));
     return time;
   }
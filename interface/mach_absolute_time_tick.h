@@ -4,95 +4,72 @@
 #define mach_absolute_time_tick_h
 
 // C++ standard headers
-#include <chrono>
+#include <atomic>
+#include <cstdint>
 
 // Darwin system headers
 #include <mach/mach.h>
 #include <mach/mach_time.h>
 #define HAVE_MACH_ABSOLUTE_TIME
 
+#include "interface/runtime_tick.h"
 
-// mach_absolute_time ticks as clock period
-// XXX should it use unsigned integers ?
-struct mach_absolute_time_tick {
-  static const double  ticks_per_second;
-  static const double  seconds_per_tick;
-  static const int64_t nanoseconds_per_tick_shifted;
-  static const int64_t ticks_per_nanosecond_shifted;
-
-  static int64_t to_nanoseconds(int64_t ticks) noexcept
-  {
-    // round the shifted value away from 0, like round() does
-    // XXX should it honor fesetround instead ?
-    __int128_t shifted = (__int128_t) ticks * nanoseconds_per_tick_shifted;
-    __int128_t ns = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
-    return (int64_t) ns;
-  }
-
-  static double to_seconds(double ticks) noexcept
-  {
-    return ticks / ticks_per_second;
-  }
 
-  static int64_t from_nanoseconds(int64_t ns) noexcept {
-    // round the shifted value away from 0, like round() does
-    // XXX should it honor fesetround instead ?
-    __int128_t shifted = (__int128_t) ns * ticks_per_nanosecond_shifted;
-    __int128_t ticks = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
-    return (int64_t) ticks;
-  }
+// mach_absolute_time, as the source of runtime_tick
+//
+// The timebase does not change, so the ratios are read once, when the program starts. The first
+// epoch of the timestamps is the value of mach_absolute_time when it is first converted, converted
+// exactly with the timebase ratio; like for tsc_counter, it is moved forward by the conversions that
+// find it too far behind, so that the timestamps keep using a 64-bit multiply (the 64-bit range is
+// only about 4 s of the 24 MHz timebase).
+struct mach_absolute_time_counter {
+  static const double      ticks_per_second_value;
+  static const double      seconds_per_tick_value;
+  static const ns2cyc_data ns2cyc;
 
-  static int64_t from_seconds(double seconds) noexcept {
-    // XXX use lrint intead of lround (honors fesetround) ?
-    return (int64_t) std::lround(seconds * ticks_per_second);
+  static cyc2ns_data get_cyc2ns() noexcept
+  {
+    cyc2ns_data c;
+    // set the first epoch, if it has not been done yet
+    while (cyc2ns.load(c) == 0)
+      initialise();
+    return c;
   }
 
-  template <typename _ToRep, typename _ToPeriod>
-  static
-  typename std::enable_if<
-    std::chrono::treat_as_floating_point<_ToRep>::value,
-    std::chrono::duration<_ToRep, _ToPeriod>>::type
-  to_duration(double ticks)
+  static ns2cyc_data get_ns2cyc() noexcept
   {
-    std::chrono::duration<double> d(to_seconds(ticks));
-    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+    return ns2cyc;
   }
 
-  template <typename _ToRep, typename _ToPeriod>
-  static
-  typename std::enable_if<
-    not std::chrono::treat_as_floating_point<_ToRep>::value,
-    std::chrono::duration<_ToRep, _ToPeriod>>::type
-  to_duration(int64_t ticks)
+  static double ticks_per_second() noexcept
   {
-    std::chrono::nanoseconds d(to_nanoseconds(ticks));
-    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+    return ticks_per_second_value;
   }
 
-  template <typename _FromRep, typename _FromPeriod>
-  static
-  typename std::enable_if<
-    std::chrono::treat_as_floating_point<_FromRep>::value,
-    double>::type
-  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  static double seconds_per_tick() noexcept
   {
-    double s = std::chrono::duration_cast<std::chrono::duration<double>>(d).count();
-    return from_seconds(s);
+    return seconds_per_tick_value;
   }
 
-  template <typename _FromRep, typename _FromPeriod>
-  static
-  typename std::enable_if<
-    not std::chrono::treat_as_floating_point<_FromRep>::value,
-    int64_t>::type
-  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  static uint32_t generation() noexcept
   {
-    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
-    return from_nanoseconds(ns);
+    return 1;
   }
 
+  // convert a value far from the epoch with a 128-bit multiply, and move the epoch forward to it
+  static int64_t to_timestamp_far(int64_t ticks) noexcept;
+
+private:
+  // set the first epoch, unless another thread is already doing it
+  static void initialise() noexcept;
+
+  static seqlock<cyc2ns_data> cyc2ns;
+  static std::atomic_flag     writer;
 };
 
+// mach_absolute_time ticks as clock period
+typedef runtime_tick<mach_absolute_time_counter> mach_absolute_time_tick;
+
 
 #endif // mach_absolute_time_tick_h
 
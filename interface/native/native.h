@@ -11,6 +11,8 @@
 // C++ standard headers
 #include <chrono>
 
+#include "interface/duration_rounding.h"
+
 namespace native {
 
   template <typename _Rep, typename _Period = std::ratio<1>>
@@ -243,6 +245,29 @@ namespace std {
       return _ToDur(_ToDur::period::template from_duration<_Rep, _Period>(__d));
     }
 
+    /// floor, ceil and round, from native to standard durations; unlike duration_cast, these
+    /// are also provided before C++17, and round() rounds the ties to even, like the standard one
+    template<typename _ToDur, typename _Rep, typename _Period>
+    constexpr typename enable_if<!native::__is_native_duration<_ToDur>::value, _ToDur>::type
+    floor(native::native_duration<_Rep, _Period> const & __d)
+    {
+      return _Period::template to_duration<typename _ToDur::rep, typename _ToDur::period>(__d.count(), duration_rounding::floor);
+    }
+
+    template<typename _ToDur, typename _Rep, typename _Period>
+    constexpr typename enable_if<!native::__is_native_duration<_ToDur>::value, _ToDur>::type
+    ceil(native::native_duration<_Rep, _Period> const & __d)
+    {
+      return _Period::template to_duration<typename _ToDur::rep, typename _ToDur::period>(__d.count(), duration_rounding::ceil);
+    }
+
+    template<typename _ToDur, typename _Rep, typename _Period>
+    constexpr typename enable_if<!native::__is_native_duration<_ToDur>::value, _ToDur>::type
+    round(native::native_duration<_Rep, _Period> const & __d)
+    {
+      return _Period::template to_duration<typename _ToDur::rep, typename _ToDur::period>(__d.count(), duration_rounding::nearest);
+    }
+
   } // namespace
 } // namespace
 
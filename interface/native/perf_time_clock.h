@@ -0,0 +1,41 @@
+#ifndef native_perf_time_clock_h
+#define native_perf_time_clock_h
+
+// C++ standard headers
+#include <chrono>
+
+#include "interface/x86_tsc.h"
+#include "interface/perf_time_tick.h"
+#include "interface/native/native.h"
+
+#ifdef HAVE_PERF_TIME_TICK
+
+namespace native {
+
+  // TSC-based clock with native duration, whose timestamps are converted with the parameters of the
+  // perf_event mmap page, so they are in the same time domain as the perf_event samples
+  struct clock_perf_time
+  {
+    // std::chrono-like native interface
+    typedef native_duration<int64_t, perf_time_tick>                    duration;
+    typedef duration::rep                                               rep;
+    typedef duration::period                                            period;
+    typedef native_time_point<clock_perf_time, duration>                time_point;
+
+    static const bool is_steady;
+    static const bool is_available;
+
+    static time_point now() noexcept
+    {
+      rep        ticks = rdtsc();
+      duration   d(ticks);
+      time_point t(d);
+      return t;
+    }
+  };
+
+} // namespace native
+
+#endif // HAVE_PERF_TIME_TICK
+
+#endif // native_perf_time_clock_h
@@ -6,6 +6,9 @@
 
 #include "interface/x86_tsc.h"
 #include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_realtime.h"
+#include "interface/x86_tsc_sync.h"
+#include "interface/x86_tsc_cpu.h"
 #include "interface/native/native.h"
 
 namespace native {
@@ -111,6 +114,96 @@ namespace native {
 #endif
 
 
+#ifdef CHRONO_HAVE_RDTSCP
+  // TSC-based clock with native duration, using rdtscp as serialising instruction, that can also
+  // return the CPU and NUMA node the TSC was read on
+  struct clock_rdtscp_cpu
+  {
+    // std::chrono-like native interface
+    typedef native_duration<int64_t, tsc_tick>                          duration;
+    typedef duration::rep                                               rep;
+    typedef duration::period                                            period;
+    typedef native_time_point<clock_rdtscp_cpu, duration>               time_point;
+
+    static const bool is_steady;
+    static const bool is_available;
+
+    static time_point now() noexcept
+    {
+      tsc_aux aux;
+      return now(aux);
+    }
+
+    // also return the CPU and node the TSC was read on
+    static time_point now(tsc_aux & aux) noexcept
+    {
+      rep        ticks = rdtscp(& aux.value);
+      duration   d(ticks);
+      time_point t(d);
+      return t;
+    }
+  };
+#endif
+
+
+#ifdef CHRONO_HAVE_RDPID
+  // TSC-based clock with native duration, using rdtsc (non-serialising) between two rdpid, that
+  // can also return the CPU and NUMA node the TSC was read on
+  struct clock_rdpid_cpu
+  {
+    // std::chrono-like native interface
+    typedef native_duration<int64_t, tsc_tick>                          duration;
+    typedef duration::rep                                               rep;
+    typedef duration::period                                            period;
+    typedef native_time_point<clock_rdpid_cpu, duration>                time_point;
+
+    static const bool is_steady;
+    static const bool is_available;
+
+    static time_point now() noexcept
+    {
+      tsc_aux aux;
+      return now(aux);
+    }
+
+    // also return the CPU and node the TSC was read on
+    static time_point now(tsc_aux & aux) noexcept
+    {
+      rep        ticks = rdtsc_rdpid(& aux.value);
+      duration   d(ticks);
+      time_point t(d);
+      return t;
+    }
+  };
+#endif
+
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+  // TSC-based clock with native duration, using rdtscp as serialising instruction, and subtracting
+  // the offset of the CPU it was read on, as measured by tsc_cpu_offsets::measure()
+  struct clock_rdtscp_compensated
+  {
+    // std::chrono-like native interface
+    typedef native_duration<int64_t, tsc_tick>                          duration;
+    typedef duration::rep                                               rep;
+    typedef duration::period                                            period;
+    typedef native_time_point<clock_rdtscp_compensated, duration>       time_point;
+
+    static const bool is_steady;
+    static const bool is_available;
+
+    static time_point now() noexcept
+    {
+      unsigned int id;
+      rep        ticks = rdtscp(& id) - tsc_cpu_offsets::get(id);
+      duration   d(ticks);
+      time_point t(d);
+      return t;
+    }
+  };
+#endif
+
+
   // TSC-based clock, determining at run-time the best strategy to serialise the reads from the TSC
   struct clock_serialising_rdtsc
   {
@@ -132,6 +225,30 @@ namespace native {
     }
   };
 
+  // TSC-based wall-clock time with native duration, using rdtsc (non-serialising); see tsc_realtime
+  // for the error between two resyncs. The time points hold the time since 1970 in tsc_realtime_tick
+  // units, the TSC value plus the offset of the last anchor, so that time_since_epoch() converts to
+  // the wall-clock time like the time points of std::chrono::system_clock
+  struct clock_tsc_realtime
+  {
+    // std::chrono-like native interface
+    typedef native_duration<int64_t, tsc_realtime_tick>                 duration;
+    typedef duration::rep                                               rep;
+    typedef duration::period                                            period;
+    typedef native_time_point<clock_tsc_realtime, duration>             time_point;
+
+    static const bool is_steady;
+    static const bool is_available;
+
+    static time_point now() noexcept
+    {
+      rep        ticks = rdtsc();
+      duration   d(ticks + tsc_realtime::get(ticks).offset_ticks);
+      time_point t(d);
+      return t;
+    }
+  };
+
 
 } // namespace native
 
@@ -0,0 +1,51 @@
+#ifndef perf_event_time_h
+#define perf_event_time_h
+
+// C++ standard headers
+#include <cstdint>
+
+#include "interface/runtime_tick.h"
+
+#if defined(__linux__)
+#define HAVE_PERF_EVENT_TIME
+#endif // defined(__linux__)
+
+#ifdef HAVE_PERF_EVENT_TIME
+
+// Conversion from TSC ticks to nanoseconds used by the kernel for the perf_event timestamps,
+// as published in the perf_event_mmap_page:
+//
+//   quot = cyc >> time_shift;
+//   rem  = cyc & ((1 << time_shift) - 1);
+//   ns   = time_zero + quot * time_mult + ((rem * time_mult) >> time_shift);
+//
+struct perf_event_time_parameters {
+  uint64_t time_zero;
+  uint32_t time_mult;
+  uint16_t time_shift;
+};
+
+// open a software perf event and read the TSC conversion parameters from its mmap page;
+// return false if perf events are not available, or if the kernel does not support the
+// conversion of the TSC in user space (cap_user_time or cap_user_time_zero are not set, e.g.
+// in virtual machines without a stable TSC)
+bool read_perf_event_time_parameters(perf_event_time_parameters & params);
+
+// the same conversion, in the form used by runtime_tick
+struct perf_event_time_conversion {
+  double      ticks_per_second;
+  double      seconds_per_tick;
+  cyc2ns_data cyc2ns;
+  ns2cyc_data ns2cyc;
+};
+
+// timestamp of a TSC value, including its sub-nanosecond part, with the same arithmetic as the kernel
+void perf_event_timestamp(perf_event_time_parameters const & params, int64_t ticks, int64_t & ns, uint64_t & fraction);
+
+// derive the conversion from the kernel's parameters, with the epoch of the timestamps at the given
+// TSC value
+perf_event_time_conversion perf_event_conversion(perf_event_time_parameters const & params, int64_t epoch_ticks);
+
+#endif // HAVE_PERF_EVENT_TIME
+
+#endif // perf_event_time_h
@@ -0,0 +1,94 @@
+#ifndef perf_time_tick_h
+#define perf_time_tick_h
+
+// C++ standard headers
+#include <atomic>
+#include <cstdint>
+
+#include "interface/x86_tsc.h"
+#include "interface/perf_event_time.h"
+#include "interface/seqlock.h"
+#include "interface/runtime_tick.h"
+
+#if defined(HAVE_PERF_EVENT_TIME) && defined(CHRONO_HAVE_TSC)
+#define HAVE_PERF_TIME_TICK
+
+// the TSC, converted with the parameters of the perf_event mmap page, as the source of runtime_tick
+//
+// The parameters are read once, when the program starts, and never change; unlike tsc_tick, that
+// may fall back to a calibration or refine the frequency, the timestamps are always the ones the
+// kernel computes for the perf_event samples, i.e.
+//
+//   time_zero + (tsc * time_mult) >> time_shift
+//
+// with the same rounding, so events recorded in process can be merged with the samples of the
+// same perf clock without any post-processing.
+//
+// The timestamps are computed relative to an epoch that is moved forward whenever a TSC value is
+// too far from it, keeping the sub-nanosecond part, so the results are the same as the formula above.
+struct perf_time_counter {
+  static cyc2ns_data get_cyc2ns() noexcept
+  {
+    cyc2ns_data c;
+    cyc2ns.load(c);
+    return c;
+  }
+
+  static ns2cyc_data get_ns2cyc() noexcept
+  {
+    return constants.ns2cyc;
+  }
+
+  static double ticks_per_second() noexcept
+  {
+    return constants.ticks_per_second;
+  }
+
+  static double seconds_per_tick() noexcept
+  {
+    return constants.seconds_per_tick;
+  }
+
+  // 0 until the parameters have been read, 1 afterwards
+  static uint32_t generation() noexcept
+  {
+    return constants.parameters.time_mult != 0 ? 1 : 0;
+  }
+
+  // convert a TSC value far from the epoch with a 128-bit multiply, and move the epoch to it
+  static int64_t to_timestamp_far(int64_t ticks) noexcept;
+
+  // true if the kernel publishes the conversion of the TSC to the perf clock
+  static bool is_available() noexcept
+  {
+    return constants.parameters.time_mult != 0;
+  }
+
+  // parameters read from the perf_event mmap page, all zero if they are not available
+  static perf_event_time_parameters const & parameters() noexcept
+  {
+    return constants.parameters;
+  }
+
+  struct constant_data {
+    perf_event_time_parameters parameters;
+    double                     ticks_per_second;
+    double                     seconds_per_tick;
+    ns2cyc_data                ns2cyc;
+  };
+
+private:
+  // set when the program starts, before the objects without an explicit initialisation priority
+  static const constant_data constants;
+
+  // zero-initialised, so it can be used safely from other static initialisers
+  static seqlock<cyc2ns_data> cyc2ns;
+  static std::atomic_flag     epoch_writer;
+};
+
+// TSC ticks, converted like the perf_event timestamps, as clock period
+typedef runtime_tick<perf_time_counter> perf_time_tick;
+
+#endif // defined(HAVE_PERF_EVENT_TIME) && defined(CHRONO_HAVE_TSC)
+
+#endif // perf_time_tick_h
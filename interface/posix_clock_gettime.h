@@ -3,12 +3,16 @@
 
 // C++ standard headers
 #include <chrono>
+#include <type_traits>
 
 // POSIX standard headers
 #ifndef _WIN32
 #include <unistd.h>
 #endif
 #include <time.h>
+#if defined(_POSIX_THREAD_CPUTIME) && (_POSIX_THREAD_CPUTIME >= 0)
+#include <pthread.h>
+#endif
 
 // check available capabilities
 #if (defined(_POSIX_TIMERS) && (_POSIX_TIMERS >= 0))
@@ -39,199 +43,253 @@
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 39)
 #define HAVE_POSIX_CLOCK_BOOTTIME
 #endif // LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 39)
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 0, 0) && defined(CLOCK_BOOTTIME_ALARM)
+#define HAVE_POSIX_CLOCK_REALTIME_ALARM
+#define HAVE_POSIX_CLOCK_BOOTTIME_ALARM
+#endif // LINUX_VERSION_CODE >= KERNEL_VERSION(3, 0, 0) && defined(CLOCK_BOOTTIME_ALARM)
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 10, 0) && defined(CLOCK_TAI)
+#define HAVE_POSIX_CLOCK_TAI
+#endif // LINUX_VERSION_CODE >= KERNEL_VERSION(3, 10, 0) && defined(CLOCK_TAI)
 #endif // __linux__
 
 #endif // _POSIX_TIMERS
 
 #ifdef HAVE_POSIX_CLOCK_REALTIME
-// based on clock_gettime(CLOCK_REALTIME, ...)
-struct clock_gettime_realtime
-{
-  typedef std::chrono::nanoseconds                                      duration;
-  typedef duration::rep                                                 rep;
-  typedef duration::period                                              period;
-  typedef std::chrono::time_point<clock_gettime_realtime, duration>     time_point;
-
-  static constexpr bool is_steady = false;
-  static const     bool is_available;
+// the clocks that are known to be available at compile time, whose is_available is a constant:
+// those whose POSIX option is supported unconditionally (a feature macro greater than 0), and the
+// Linux clocks that exist in all the kernels the HAVE_POSIX_CLOCK_* checks accept
+template <clockid_t Id>
+struct posix_clock_always_available : public std::false_type { };
 
-  static time_point now() noexcept
-  {
-    timespec t;
-    clock_gettime(CLOCK_REALTIME, &t);
+#if defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0)
+template <> struct posix_clock_always_available<CLOCK_REALTIME> : public std::true_type { };
+#endif // _POSIX_TIMERS > 0
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
+#if defined(HAVE_POSIX_CLOCK_MONOTONIC) && (_POSIX_MONOTONIC_CLOCK > 0)
+template <> struct posix_clock_always_available<CLOCK_MONOTONIC> : public std::true_type { };
+#endif // _POSIX_MONOTONIC_CLOCK > 0
 
-};
-#endif // HAVE_POSIX_CLOCK_REALTIME
+#if defined(HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID) && (_POSIX_CPUTIME > 0)
+template <> struct posix_clock_always_available<CLOCK_PROCESS_CPUTIME_ID> : public std::true_type { };
+#endif // _POSIX_CPUTIME > 0
 
+#if defined(HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID) && (_POSIX_THREAD_CPUTIME > 0)
+template <> struct posix_clock_always_available<CLOCK_THREAD_CPUTIME_ID> : public std::true_type { };
+#endif // _POSIX_THREAD_CPUTIME > 0
 
 #ifdef HAVE_POSIX_CLOCK_REALTIME_COARSE
-// based on clock_gettime(CLOCK_REALTIME_COARSE, ...)
-struct clock_gettime_realtime_coarse
-{
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_gettime_realtime_coarse, duration>  time_point;
-
-  static constexpr bool is_steady = false;
-  static const     bool is_available;
-
-  static time_point now() noexcept
-  {
-    timespec t;
-    clock_gettime(CLOCK_REALTIME_COARSE, &t);
+template <> struct posix_clock_always_available<CLOCK_REALTIME_COARSE> : public std::true_type { };
+template <> struct posix_clock_always_available<CLOCK_MONOTONIC_COARSE> : public std::true_type { };
+#endif // HAVE_POSIX_CLOCK_REALTIME_COARSE
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC_RAW
+template <> struct posix_clock_always_available<CLOCK_MONOTONIC_RAW> : public std::true_type { };
+#endif // HAVE_POSIX_CLOCK_MONOTONIC_RAW
 
-};
-#endif // HAVE_POSIX_CLOCK_REALTIME_COARSE
+#ifdef HAVE_POSIX_CLOCK_BOOTTIME
+template <> struct posix_clock_always_available<CLOCK_BOOTTIME> : public std::true_type { };
+#endif // HAVE_POSIX_CLOCK_BOOTTIME
 
 
-#ifdef HAVE_POSIX_CLOCK_MONOTONIC
-// based on clock_gettime(CLOCK_MONOTONIC, ...)
-struct clock_gettime_monotonic
+// based on clock_gettime(Id, ...), for any clock id known at compile time
+//
+// is_available is constant-initialised for the clocks that are always available, and set by a
+// dynamic initialiser for the others, so it may not be set yet during the dynamic initialisation
+// of other translation units; available() returns the same value, and can be called at any time.
+template <clockid_t Id, bool Steady>
+struct posix_clock
 {
   typedef std::chrono::nanoseconds                                      duration;
   typedef duration::rep                                                 rep;
   typedef duration::period                                              period;
-  typedef std::chrono::time_point<clock_gettime_monotonic, duration>    time_point;
+  typedef std::chrono::time_point<posix_clock, duration>                time_point;
+
+  static constexpr clockid_t id        = Id;
+  static constexpr bool      is_steady = Steady;
+  static const     bool      is_available;
 
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
+  static bool available() noexcept;
 
   static time_point now() noexcept
   {
     timespec t;
-    clock_gettime(CLOCK_MONOTONIC, &t);
+    clock_gettime(Id, &t);
 
     return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
   }
 
 };
-#endif // HAVE_POSIX_CLOCK_MONOTONIC
-
 
-#ifdef HAVE_POSIX_CLOCK_MONOTONIC_COARSE
-// based on clock_gettime(CLOCK_MONOTONIC_COARSE, ...)
-struct clock_gettime_monotonic_coarse
+// check if a clock can be read
+inline bool posix_clock_is_available(clockid_t id) noexcept
 {
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_gettime_monotonic_coarse, duration> time_point;
+  timespec t;
+  return clock_gettime(id, &t) == 0;
+}
 
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
+template <clockid_t Id, bool Steady>
+constexpr clockid_t posix_clock<Id, Steady>::id;
 
-  static time_point now() noexcept
-  {
-    timespec t;
-    clock_gettime(CLOCK_MONOTONIC_COARSE, &t);
+template <clockid_t Id, bool Steady>
+constexpr bool posix_clock<Id, Steady>::is_steady;
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
+// by default, a clock is available if it can be read; the clocks defined by POSIX use sysconf()
+// instead, see posix_clock_gettime.cc
+template <clockid_t Id, bool Steady>
+bool posix_clock<Id, Steady>::available() noexcept
+{
+  static const bool value = posix_clock_always_available<Id>::value || posix_clock_is_available(Id);
+  return value;
+}
 
-};
-#endif // HAVE_POSIX_CLOCK_MONOTONIC_COARSE
+// a constant expression for the clocks that are always available, as the call is not evaluated
+template <clockid_t Id, bool Steady>
+const bool posix_clock<Id, Steady>::is_available = posix_clock_always_available<Id>::value || posix_clock<Id, Steady>::available();
 
 
-#ifdef HAVE_POSIX_CLOCK_MONOTONIC_RAW
-// based on clock_gettime(CLOCK_MONOTONIC_RAW, ...)
-struct clock_gettime_monotonic_raw
+// based on clock_gettime(id, ...), for a clock id only known at run time, e.g. the cpu time clock of
+// a thread or of another process, or a dynamic clock like a PTP hardware clock
+//
+// The time points of different clocks have the same type, and should not be compared.
+struct dynamic_posix_clock
 {
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_gettime_monotonic_raw, duration>    time_point;
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<dynamic_posix_clock, duration>        time_point;
 
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
+  static constexpr bool is_steady = false;
 
-  static inline time_point now() noexcept
-  {
-    timespec t;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+  explicit dynamic_posix_clock(clockid_t id) noexcept :
+    id_(id),
+    available_(posix_clock_is_available(id))
+  { }
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
+#if defined(_POSIX_THREAD_CPUTIME) && (_POSIX_THREAD_CPUTIME >= 0)
+  // the cpu time clock of a thread
+  static dynamic_posix_clock thread_cputime(pthread_t thread) noexcept
+  {
+    clockid_t id;
+    if (pthread_getcpuclockid(thread, & id) != 0)
+      return unavailable();
+    return dynamic_posix_clock(id);
   }
+#endif // _POSIX_THREAD_CPUTIME
 
-};
-#endif // HAVE_POSIX_CLOCK_MONOTONIC_RAW
+#if defined(_POSIX_CPUTIME) && (_POSIX_CPUTIME >= 0)
+  // the cpu time clock of a process
+  static dynamic_posix_clock process_cputime(pid_t pid) noexcept
+  {
+    clockid_t id;
+    if (clock_getcpuclockid(pid, & id) != 0)
+      return unavailable();
+    return dynamic_posix_clock(id);
+  }
+#endif // _POSIX_CPUTIME
 
+#ifdef __linux__
+  // the clock of an open character device, e.g. /dev/ptp0; the file descriptor must stay open
+  // while the clock is used
+  static dynamic_posix_clock from_file_descriptor(int fd) noexcept
+  {
+    return dynamic_posix_clock((clockid_t) ((~(unsigned int) fd << 3) | 3));
+  }
+#endif // __linux__
 
-#ifdef HAVE_POSIX_CLOCK_BOOTTIME
-// based on clock_gettime(CLOCK_BOOTTIME, ...)
-struct clock_gettime_boottime
-{
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_gettime_boottime, duration>         time_point;
+  clockid_t id() const noexcept
+  {
+    return id_;
+  }
 
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
+  bool is_available() const noexcept
+  {
+    return available_;
+  }
 
-  static inline time_point now() noexcept
+  time_point now() const noexcept
   {
     timespec t;
-    clock_gettime(CLOCK_BOOTTIME, &t);
+    clock_gettime(id_, &t);
 
     return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
   }
 
+private:
+  dynamic_posix_clock() noexcept :
+    id_(),
+    available_(false)
+  { }
+
+  static dynamic_posix_clock unavailable() noexcept
+  {
+    return dynamic_posix_clock();
+  }
+
+  clockid_t id_;
+  bool      available_;
 };
-#endif // HAVE_POSIX_CLOCK_BOOTTIME
+#endif // HAVE_POSIX_CLOCK_REALTIME
 
 
-#ifdef HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
-// based on clock_gettime(CLOCK_PROCESS_CPUTIME_ID, ...)
-struct clock_gettime_process_cputime
-{
-  typedef std::chrono::nanoseconds                                              duration;
-  typedef duration::rep                                                         rep;
-  typedef duration::period                                                      period;
-  typedef std::chrono::time_point<clock_gettime_process_cputime, duration>      time_point;
+#ifdef HAVE_POSIX_CLOCK_REALTIME
+// based on clock_gettime(CLOCK_REALTIME, ...)
+typedef posix_clock<CLOCK_REALTIME, false>                     clock_gettime_realtime;
+template <> bool clock_gettime_realtime::available() noexcept;
+#endif // HAVE_POSIX_CLOCK_REALTIME
 
-  static constexpr bool is_steady = false;  // FIXME can this be considered "steady" ?
-  static const     bool is_available;
+#ifdef HAVE_POSIX_CLOCK_REALTIME_COARSE
+// based on clock_gettime(CLOCK_REALTIME_COARSE, ...)
+typedef posix_clock<CLOCK_REALTIME_COARSE, false>              clock_gettime_realtime_coarse;
+#endif // HAVE_POSIX_CLOCK_REALTIME_COARSE
 
-  static time_point now() noexcept
-  {
-    timespec t;
-    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+#ifdef HAVE_POSIX_CLOCK_REALTIME_ALARM
+// based on clock_gettime(CLOCK_REALTIME_ALARM, ...)
+typedef posix_clock<CLOCK_REALTIME_ALARM, false>               clock_gettime_realtime_alarm;
+#endif // HAVE_POSIX_CLOCK_REALTIME_ALARM
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
+#ifdef HAVE_POSIX_CLOCK_TAI
+// based on clock_gettime(CLOCK_TAI, ...)
+typedef posix_clock<CLOCK_TAI, false>                          clock_gettime_tai;
+#endif // HAVE_POSIX_CLOCK_TAI
 
-};
-#endif // HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC
+// based on clock_gettime(CLOCK_MONOTONIC, ...)
+typedef posix_clock<CLOCK_MONOTONIC, true>                     clock_gettime_monotonic;
+template <> bool clock_gettime_monotonic::available() noexcept;
+#endif // HAVE_POSIX_CLOCK_MONOTONIC
 
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC_COARSE
+// based on clock_gettime(CLOCK_MONOTONIC_COARSE, ...)
+typedef posix_clock<CLOCK_MONOTONIC_COARSE, true>              clock_gettime_monotonic_coarse;
+#endif // HAVE_POSIX_CLOCK_MONOTONIC_COARSE
 
-#ifdef HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
-// based on clock_gettime(CLOCK_THREAD_CPUTIME_ID, ...)
-struct clock_gettime_thread_cputime
-{
-  typedef std::chrono::nanoseconds                                              duration;
-  typedef duration::rep                                                         rep;
-  typedef duration::period                                                      period;
-  typedef std::chrono::time_point<clock_gettime_thread_cputime, duration>       time_point;
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC_RAW
+// based on clock_gettime(CLOCK_MONOTONIC_RAW, ...)
+typedef posix_clock<CLOCK_MONOTONIC_RAW, true>                 clock_gettime_monotonic_raw;
+#endif // HAVE_POSIX_CLOCK_MONOTONIC_RAW
 
-  static constexpr bool is_steady = false;  // FIXME can this be considered "steady" ?
-  static const     bool is_available;
+#ifdef HAVE_POSIX_CLOCK_BOOTTIME
+// based on clock_gettime(CLOCK_BOOTTIME, ...)
+typedef posix_clock<CLOCK_BOOTTIME, true>                      clock_gettime_boottime;
+#endif // HAVE_POSIX_CLOCK_BOOTTIME
 
-  static time_point now() noexcept
-  {
-    timespec t;
-    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+#ifdef HAVE_POSIX_CLOCK_BOOTTIME_ALARM
+// based on clock_gettime(CLOCK_BOOTTIME_ALARM, ...)
+typedef posix_clock<CLOCK_BOOTTIME_ALARM, true>                clock_gettime_boottime_alarm;
+#endif // HAVE_POSIX_CLOCK_BOOTTIME_ALARM
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
+#ifdef HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
+// based on clock_gettime(CLOCK_PROCESS_CPUTIME_ID, ...)
+// FIXME can this be considered "steady" ?
+typedef posix_clock<CLOCK_PROCESS_CPUTIME_ID, false>           clock_gettime_process_cputime;
+template <> bool clock_gettime_process_cputime::available() noexcept;
+#endif // HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
 
-};
+#ifdef HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+// based on clock_gettime(CLOCK_THREAD_CPUTIME_ID, ...)
+// FIXME can this be considered "steady" ?
+typedef posix_clock<CLOCK_THREAD_CPUTIME_ID, false>            clock_gettime_thread_cputime;
+template <> bool clock_gettime_thread_cputime::available() noexcept;
 #endif // HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
 
 #endif // posix_clock_gettime_h
@@ -9,22 +9,17 @@
 #include <sys/times.h>
 #include <unistd.h>
 
+#include "interface/posix_times_scale.h"
+
 // Tested on Intel Core i5 with GCC 4.7.2
 //
 // (time * 1000000000 / ticks_per_second) adds an overhead of almost 20 ns per call, so we pre-compute 1000000000 / ticks_per_second 
 //
 //    use a long for the ratio, check if it is accurate or not, and only if it is accurate use it instead of doing the division.
 //    When accurate, (time * nanoseconds_per_tick) can be done basically for free
-
-
-// define macros to give hints on branch prediction
-#ifndef likely
-#define likely(cond) __builtin_expect(cond, 1)
-#endif // likely
-
-#ifndef unlikely
-#define unlikely(cond) __builtin_expect(cond, 0)
-#endif // unlikely
+//
+// The ratio is computed once, at program startup, in times_scale, as a multiplier and a divisor: the
+// divisor is 1 if the ratio is accurate, so that now() does not branch on it.
 
 
 // based on times()
@@ -39,15 +34,11 @@ struct clock_times_cputime
 
   static inline time_point now() noexcept
   {
-    static const long ticks_per_second = sysconf(_SC_CLK_TCK);
-    static const long nanoseconds_per_tick = 1000000000l / ticks_per_second;
-    static const bool accurate = ((1000000000l % ticks_per_second) == 0);
-
     tms cputime;
     times(& cputime);
     clock_t time = cputime.tms_utime + cputime.tms_stime;
     
-    int64_t ns = likely(accurate) ? time * nanoseconds_per_tick : time * 1000000000l / ticks_per_second;
+    int64_t ns = times_scale.to_nanoseconds(time);
     return time_point( duration( ns ));
   }
 
@@ -65,10 +56,6 @@ struct clock_times_realtime
 
   static inline time_point now() noexcept
   {
-    static const long ticks_per_second = sysconf(_SC_CLK_TCK);
-    static const long nanoseconds_per_tick = 1000000000l / ticks_per_second;
-    static const bool accurate = ((1000000000l % ticks_per_second) == 0);
-
     clock_t time;
 #ifdef __linux__
     time = times(nullptr);
@@ -77,7 +64,7 @@ struct clock_times_realtime
     time = times(& cputime);
 #endif // __linux__
     
-    int64_t ns = likely(accurate) ? time * nanoseconds_per_tick : time * 1000000000l / ticks_per_second;
+    int64_t ns = times_scale.to_nanoseconds(time);
     return time_point( duration( ns ));
   }
 
@@ -10,6 +10,8 @@
 #include <sys/times.h>
 #include <unistd.h>
 
+#include "interface/posix_times_scale.h"
+
 // based on times()
 struct clock_times_cputime_d
 {
@@ -22,14 +24,11 @@ struct clock_times_cputime_d
 
   static inline time_point now() noexcept
   {
-    static const double ticks_per_second = sysconf(_SC_CLK_TCK);
-    static const double seconds_per_tick = 1. / ticks_per_second;
-
     tms cputime;
     times(& cputime);
     clock_t time = cputime.tms_utime + cputime.tms_stime;
     
-    return time_point( duration( (double) time * seconds_per_tick ) );
+    return time_point( duration( times_scale.to_seconds((double) time) ) );
   }
 
 };
@@ -46,9 +45,6 @@ struct clock_times_realtime_d
 
   static inline time_point now() noexcept
   {
-    static const double ticks_per_second = sysconf(_SC_CLK_TCK);
-    static const double seconds_per_tick = 1. / ticks_per_second;
-
     clock_t time;
 #ifdef __linux__
     time = times(nullptr);
@@ -57,7 +53,7 @@ struct clock_times_realtime_d
     time = times(& cputime);
 #endif // __linux__
     
-    return time_point( duration( (double) time * seconds_per_tick ) ); 
+    return time_point( duration( times_scale.to_seconds((double) time) ) ); 
   }
 
 };
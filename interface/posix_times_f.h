@@ -10,6 +10,8 @@
 #include <sys/times.h>
 #include <unistd.h>
 
+#include "interface/posix_times_scale.h"
+
 // Tested on Intel Core i5 with GCC 4.7.2
 //
 // (time * 1000000000 / ticks_per_second) adds an overhead of almost 20 ns per call, so we pre-compute 1000000000 / ticks_per_second 
@@ -17,16 +19,8 @@
 //    use a long long  for the ratio, shifted left by 32 bits to store extra precision;
 //    then use a 128-bit wide multiplication instead of the division, and shift away the extra precision.
 //    Adds a very small overhead (order of 1-2 ns) with respect to the best case above
-
-
-// define macros to give hints on branch prediction
-#ifndef likely
-#define likely(cond) __builtin_expect(cond, 1)
-#endif // likely
-
-#ifndef unlikely
-#define unlikely(cond) __builtin_expect(cond, 0)
-#endif // unlikely
+//
+// The ratio is computed once, at program startup, in times_scale.
 
 
 // based on times()
@@ -41,14 +35,11 @@ struct clock_times_cputime_f
 
   static inline time_point now() noexcept
   {
-    static const long ticks_per_second = sysconf(_SC_CLK_TCK);
-    static const int64_t nanoseconds_per_tick = (1000000000ull << 32) / ticks_per_second;
-
     tms cputime;
     times(& cputime);
     clock_t time = cputime.tms_utime + cputime.tms_stime;
     
-    __int128_t ns = ((__int128_t) time * nanoseconds_per_tick) >> 32;
+    int64_t ns = times_scale.to_nanoseconds_fixed(time);
     return time_point( duration( ns ));
   }
 
@@ -66,9 +57,6 @@ struct clock_times_realtime_f
 
   static inline time_point now() noexcept
   {
-    static const long     ticks_per_second = sysconf(_SC_CLK_TCK);
-    static const int64_t nanoseconds_per_tick = (1000000000ull << 32) / ticks_per_second;
-
     clock_t time;
 #ifdef __linux__
     time = times(nullptr);
@@ -77,7 +65,7 @@ struct clock_times_realtime_f
     time = times(& cputime);
 #endif // __linux__
     
-    __int128_t ns = ((__int128_t) time * nanoseconds_per_tick) >> 32;
+    int64_t ns = times_scale.to_nanoseconds_fixed(time);
     return time_point( duration( ns ));
   }
 
@@ -0,0 +1,14 @@
+#ifndef posix_times_scale_h
+#define posix_times_scale_h
+
+#ifndef _WIN32
+
+#include "interface/tick_scale.h"
+
+// scale of the values returned by times(), read from sysconf(_SC_CLK_TCK) at program startup,
+// before the ordinary static initialisers where the platform supports it
+extern const tick_scale times_scale;
+
+#endif // !defined(_WIN32)
+
+#endif // posix_times_scale_h
@@ -0,0 +1,351 @@
+#ifndef runtime_tick_h
+#define runtime_tick_h
+
+// C++ standard headers
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ratio>
+#include <type_traits>
+
+#include "interface/seqlock.h"
+#include "interface/batch_conversion.h"
+#include "interface/duration_rounding.h"
+
+// MSVC doesn't have an __int128_t type, use abseil's version
+#ifdef _MSC_VER
+#include <absl/numeric/int128.h>
+typedef absl::int128 __int128_t;
+#endif
+
+
+// parameters used by the integer conversions from ticks to nanoseconds, like the kernel's cyc2ns_data
+struct cyc2ns_data {
+  uint64_t nanoseconds_per_tick_shifted;        // nanoseconds per tick, shifted left by 32 bits
+  uint64_t max_ticks;                           // largest value that can be converted with a 64-bit multiply
+  int64_t  epoch_ticks;                         // counter value at the epoch of the timestamps
+  int64_t  epoch_nanoseconds;                   // timestamp at the epoch, in nanoseconds
+  uint64_t epoch_fraction;                      // sub-nanosecond part of the timestamp at the epoch, in 2^-32 ns
+};
+
+// parameters used by the integer conversions from nanoseconds to ticks
+struct ns2cyc_data {
+  uint64_t ticks_per_nanosecond_shifted;        // ticks per nanosecond, shifted left by 32 bits
+  uint64_t max_nanoseconds;                     // largest value that can be converted with a 64-bit multiply
+};
+
+
+// ticks of a counter whose frequency is only known at run time, as clock period
+// XXX should it use unsigned integers ?
+//
+// The Source describes the counter, and provides the parameters of the conversions:
+//
+//   static cyc2ns_data get_cyc2ns() noexcept;
+//   static ns2cyc_data get_ns2cyc() noexcept;
+//   static double      ticks_per_second() noexcept;
+//   static double      seconds_per_tick() noexcept;
+//   static uint32_t    generation() noexcept;                      // changes whenever the frequency changes
+//   static int64_t     to_timestamp_far(int64_t ticks) noexcept;   // timestamp of a value too far from the epoch
+//
+// runtime_tick<Source> derives from it, so the rest of the interface of the Source (e.g. the
+// calibration) is available through the tick type as well.
+//
+// to_nanoseconds() and to_seconds() convert intervals; absolute values (e.g. the time since the
+// epoch of a native time point) should be converted with to_timestamp() and to_timestamp_seconds(),
+// that work on the distance from a recent epoch, so that a small error in the ratio does not turn
+// into a large offset after a long uptime.
+//
+// The integer conversions use a 64-bit multiply and shift when the product cannot overflow, and
+// fall back to a 128-bit multiply otherwise. Conversions to integer durations with a period other
+// than nanoseconds use a 64-bit factor computed for that period the first time it is used, and
+// cached until the frequency changes, so that e.g. a conversion to microseconds is a single 64x64-bit
+// multiply and shift rather than a conversion to nanoseconds followed by a division; the conversions
+// to nanoseconds through to_duration() are truncated as well, like for any other period, while
+// to_nanoseconds() rounds to the nearest nanosecond.
+template <typename Source>
+struct runtime_tick : public Source {
+
+  static int64_t to_nanoseconds(int64_t ticks) noexcept
+  {
+    // round the shifted value away from 0, like round() does
+    // XXX should it honor fesetround instead ?
+    cyc2ns_data c = Source::get_cyc2ns();
+    if ((uint64_t) ticks <= c.max_ticks)
+      return (int64_t) (((uint64_t) ticks * c.nanoseconds_per_tick_shifted + 0x80000000) >> 32);
+    __int128_t shifted = (__int128_t) ticks * (int64_t) c.nanoseconds_per_tick_shifted;
+    __int128_t ns = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
+    return (int64_t) ns;
+  }
+
+  static double to_seconds(double ticks) noexcept
+  {
+    return ticks / Source::ticks_per_second();
+  }
+
+  // convert an interval to an integer number of _Period units, with the given rounding (truncated
+  // toward zero by default, like std::chrono::duration_cast does); periods too fine for a 64-bit
+  // factor are converted exactly from nanoseconds
+  template <typename _Period>
+  static int64_t to_period(int64_t ticks, duration_rounding mode = duration_rounding::toward_zero) noexcept
+  {
+    period_factor f = get_factor<_Period>();
+    if (f.factor != 0)
+      return convert(f, ticks, mode);
+    std::chrono::nanoseconds d(to_nanoseconds(ticks));
+    return std::chrono::duration_cast<std::chrono::duration<int64_t, _Period>>( d ).count();
+  }
+
+  // convert an absolute value (rather than an interval) to a timestamp, in nanoseconds;
+  // the shifted value is truncated, like the kernel does
+  static int64_t to_timestamp(int64_t ticks) noexcept
+  {
+    cyc2ns_data c = Source::get_cyc2ns();
+    uint64_t delta = (uint64_t) (ticks - c.epoch_ticks);
+    if (delta <= c.max_ticks)
+      return c.epoch_nanoseconds + (int64_t) ((delta * c.nanoseconds_per_tick_shifted + c.epoch_fraction) >> 32);
+    return Source::to_timestamp_far(ticks);
+  }
+
+  // same, in seconds; the distance from the epoch is computed with integers, so the precision
+  // depends on that distance rather than on the uptime, unlike to_seconds() on an absolute value.
+  // The rate is taken from the same snapshot as the epoch, so a new frequency published in the
+  // meantime cannot be applied to the old epoch
+  static double to_timestamp_seconds(int64_t ticks) noexcept
+  {
+    cyc2ns_data c = Source::get_cyc2ns();
+    double epoch = (double) c.epoch_nanoseconds + (double) c.epoch_fraction / 4294967296.;
+    double nanoseconds_per_tick = (double) c.nanoseconds_per_tick_shifted / 4294967296.;
+    return ((double) (ticks - c.epoch_ticks) * nanoseconds_per_tick + epoch) * 1.e-9;
+  }
+
+  // convert a timestamp, in nanoseconds, back to an absolute value
+  static int64_t from_timestamp(int64_t ns) noexcept
+  {
+    cyc2ns_data c = Source::get_cyc2ns();
+    return c.epoch_ticks + from_nanoseconds(ns - c.epoch_nanoseconds);
+  }
+
+  static int64_t from_nanoseconds(int64_t ns) noexcept {
+    // round the shifted value away from 0, like round() does
+    // XXX should it honor fesetround instead ?
+    ns2cyc_data c = Source::get_ns2cyc();
+    if ((uint64_t) ns <= c.max_nanoseconds)
+      return (int64_t) (((uint64_t) ns * c.ticks_per_nanosecond_shifted + 0x80000000) >> 32);
+    __int128_t shifted = (__int128_t) ns * (int64_t) c.ticks_per_nanosecond_shifted;
+    __int128_t ticks = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
+    return (int64_t) ticks;
+  }
+
+  static int64_t from_seconds(double seconds) noexcept {
+    // XXX use lrint intead of lround (honors fesetround) ?
+    return (int64_t) std::lround(seconds * Source::ticks_per_second());
+  }
+
+  // batch conversions of intervals, with the same results as the conversions of single values;
+  // from_seconds() returns fractional ticks, as used by native durations with a floating point rep
+  static void to_nanoseconds(const int64_t * ticks, int64_t * ns, size_t size) noexcept
+  {
+    batch_multiply_shifted(ticks, ns, size, Source::get_cyc2ns().nanoseconds_per_tick_shifted);
+  }
+
+  static void to_seconds(const double * ticks, double * seconds, size_t size) noexcept
+  {
+    batch_divide(ticks, seconds, size, Source::ticks_per_second());
+  }
+
+  static void from_nanoseconds(const int64_t * ns, int64_t * ticks, size_t size) noexcept
+  {
+    batch_multiply_shifted(ns, ticks, size, Source::get_ns2cyc().ticks_per_nanosecond_shifted);
+  }
+
+  static void from_seconds(const double * seconds, double * ticks, size_t size) noexcept
+  {
+    batch_multiply(seconds, ticks, size, Source::ticks_per_second());
+  }
+
+  template <typename _ToRep, typename _ToPeriod>
+  static
+  typename std::enable_if<
+    std::chrono::treat_as_floating_point<_ToRep>::value,
+    std::chrono::duration<_ToRep, _ToPeriod>>::type
+  to_duration(double ticks, duration_rounding = duration_rounding::toward_zero)
+  {
+    // like std::chrono::floor, ceil and round, the rounding only applies to integer durations
+    std::chrono::duration<double> d(to_seconds(ticks));
+    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+  }
+
+  template <typename _ToRep, typename _ToPeriod>
+  static
+  typename std::enable_if<
+    !std::chrono::treat_as_floating_point<_ToRep>::value,
+    std::chrono::duration<_ToRep, _ToPeriod>>::type
+  to_duration(int64_t ticks, duration_rounding mode = duration_rounding::toward_zero)
+  {
+    // convert directly to the target period, rather than to nanoseconds and then to the target
+    return std::chrono::duration<_ToRep, _ToPeriod>(static_cast<_ToRep>(to_period<_ToPeriod>(ticks, mode)));
+  }
+
+  // convert an absolute value to the time since the epoch of the timestamps
+  template <typename _ToRep, typename _ToPeriod>
+  static
+  typename std::enable_if<
+    std::chrono::treat_as_floating_point<_ToRep>::value,
+    std::chrono::duration<_ToRep, _ToPeriod>>::type
+  to_timestamp_duration(int64_t ticks)
+  {
+    std::chrono::duration<double> d(to_timestamp_seconds(ticks));
+    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+  }
+
+  template <typename _ToRep, typename _ToPeriod>
+  static
+  typename std::enable_if<
+    !std::chrono::treat_as_floating_point<_ToRep>::value,
+    std::chrono::duration<_ToRep, _ToPeriod>>::type
+  to_timestamp_duration(int64_t ticks)
+  {
+    std::chrono::nanoseconds d(to_timestamp(ticks));
+    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+  }
+
+  template <typename _FromRep, typename _FromPeriod>
+  static
+  typename std::enable_if<
+    std::chrono::treat_as_floating_point<_FromRep>::value,
+    double>::type
+  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  {
+    double s = std::chrono::duration_cast<std::chrono::duration<double>>(d).count();
+    return from_seconds(s);
+  }
+
+  template <typename _FromRep, typename _FromPeriod>
+  static
+  typename std::enable_if<
+    !std::chrono::treat_as_floating_point<_FromRep>::value,
+    int64_t>::type
+  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    return from_nanoseconds(ns);
+  }
+
+private:
+  // units of a period per tick, shifted left by shift bits
+  struct period_factor {
+    uint64_t factor;                            // 0 if the period is too fine to be represented
+    uint32_t shift;
+    uint32_t generation;                        // Source::generation() when the factor was computed
+  };
+
+  // one cache for each target period, zero-initialised
+  template <typename _Period>
+  struct period_cache {
+    static seqlock<period_factor> factor;
+    static std::atomic_flag       writer;
+  };
+
+  // compute the factor from the conversion to nanoseconds, so that the results are consistent with it:
+  // units per tick = nanoseconds_per_tick_shifted * den / (num * 10^9 * 2^32)
+  //
+  // Use the largest shift that keeps the factor below 2^64, so that it keeps 64 significant bits and
+  // the 128-bit product is exact for any value; the factor is rounded up, so that a number of ticks
+  // that corresponds exactly to a whole number of units is not truncated to the unit below.
+  template <typename _Period>
+  static period_factor compute_factor(uint32_t generation) noexcept
+  {
+    const __int128_t numerator   = (__int128_t) Source::get_cyc2ns().nanoseconds_per_tick_shifted * _Period::den;
+    const __int128_t denominator = ((__int128_t) _Period::num * 1000000000) << 32;
+    const __int128_t limit       = (__int128_t) 1 << 64;
+
+    period_factor f = { 0, 0, generation };
+    __int128_t quotient  = numerator / denominator;
+    __int128_t remainder = numerator % denominator;
+    if (quotient >= limit)
+      return f;
+
+    // long division, one bit at a time
+    uint32_t shift = 0;
+    while (shift < 127) {
+      __int128_t next = quotient * 2 + (remainder * 2 >= denominator);
+      if (next >= limit)
+        break;
+      remainder = remainder * 2 >= denominator ? remainder * 2 - denominator : remainder * 2;
+      quotient  = next;
+      ++shift;
+    }
+    if (remainder != 0)
+      quotient += 1;
+    if (quotient >= limit) {
+      quotient /= 2;
+      --shift;
+    }
+    f.factor = (uint64_t) quotient;
+    f.shift  = shift;
+    return f;
+  }
+
+  // multiply the magnitude, so that the shift truncates toward zero, and round the magnitude up
+  // as needed by the rounding mode; the factor is rounded up by less than one, so a remainder below
+  // the magnitude is within its error, and is treated as an exact result
+  static int64_t convert(period_factor const & f, int64_t ticks, duration_rounding mode) noexcept
+  {
+    uint64_t   magnitude = ticks < 0 ? - (uint64_t) ticks : (uint64_t) ticks;
+    __int128_t product   = (__int128_t) magnitude * (__int128_t) f.factor;
+    uint64_t   units     = (uint64_t) (product >> f.shift);
+    if (mode != duration_rounding::toward_zero) {
+      __int128_t remainder = product - ((__int128_t) units << f.shift);
+      bool up = false;
+      switch (mode) {
+        case duration_rounding::toward_zero:
+          break;
+        case duration_rounding::floor:
+          up = ticks < 0 && remainder >= (__int128_t) magnitude;
+          break;
+        case duration_rounding::ceil:
+          up = ticks > 0 && remainder >= (__int128_t) magnitude;
+          break;
+        case duration_rounding::nearest:
+          // a remainder within the error of the factor above one half is a tie, that goes to the
+          // even value, like std::chrono::round
+          if (f.shift > 0) {
+            __int128_t half = (__int128_t) 1 << (f.shift - 1);
+            up = remainder >= half + (__int128_t) magnitude || (remainder >= half && (units & 1) != 0);
+          }
+          break;
+      }
+      units += up;
+    }
+    return ticks < 0 ? - (int64_t) units : (int64_t) units;
+  }
+
+  // return the cached factor, or compute it if the frequency has changed since it was cached
+  template <typename _Period>
+  static period_factor get_factor() noexcept
+  {
+    period_factor f;
+    uint32_t generation = Source::generation();
+    if (period_cache<_Period>::factor.load(f) == 0 || f.generation != generation) {
+      f = compute_factor<_Period>(generation);
+      // serialise the writers; a thread that loses the race uses its own copy
+      if (!period_cache<_Period>::writer.test_and_set(std::memory_order_acquire)) {
+        period_cache<_Period>::factor.store(f);
+        period_cache<_Period>::writer.clear(std::memory_order_release);
+      }
+    }
+    return f;
+  }
+};
+
+template <typename Source>
+template <typename _Period>
+seqlock<typename runtime_tick<Source>::period_factor> runtime_tick<Source>::period_cache<_Period>::factor;
+
+template <typename Source>
+template <typename _Period>
+std::atomic_flag runtime_tick<Source>::period_cache<_Period>::writer = ATOMIC_FLAG_INIT;
+
+
+#endif // runtime_tick_h
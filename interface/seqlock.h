@@ -0,0 +1,65 @@
+#ifndef seqlock_h
+#define seqlock_h
+
+// C++ standard headers
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Sequence lock protecting a small, trivially copyable object.
+//
+// A single writer at a time publishes a new value; readers never take a lock and never block the
+// writer: they copy the value and retry if an update happened at the same time, so they never see
+// a torn value. The data is stored as relaxed atomic words, so that the concurrent accesses are
+// well defined; on x86 both reads and writes compile to plain moves.
+template <typename T>
+class seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "seqlock requires a trivially copyable type");
+
+public:
+  // copy the current value; return its sequence number, or 0 if no value has ever been stored
+  uint32_t load(T & value) const noexcept
+  {
+    uint64_t buffer[words];
+    uint32_t seq;
+    do {
+      seq = sequence.load(std::memory_order_acquire);
+      for (size_t i = 0; i < words; ++i)
+        buffer[i] = data[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != sequence.load(std::memory_order_relaxed));
+    memcpy(& value, buffer, sizeof(T));
+    return seq;
+  }
+
+  T load() const noexcept
+  {
+    T value;
+    load(value);
+    return value;
+  }
+
+  // publish a new value; concurrent writers must be serialised by the caller
+  void store(T const & value) noexcept
+  {
+    uint64_t buffer[words] = {};
+    memcpy(buffer, & value, sizeof(T));
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < words; ++i)
+      data[i].store(buffer[i], std::memory_order_relaxed);
+    // skip 0 on wrap around, it is reserved for "never stored"
+    sequence.store(seq + 2 != 0 ? seq + 2 : 2, std::memory_order_release);
+  }
+
+private:
+  static constexpr size_t words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  // objects with static storage duration are zero-initialised before any dynamic initialisation
+  std::atomic<uint32_t> sequence;
+  std::atomic<uint64_t> data[words];
+};
+
+#endif // seqlock_h
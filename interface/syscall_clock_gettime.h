@@ -3,6 +3,7 @@
 
 // C++ standard headers
 #include <chrono>
+#include <type_traits>
 
 // POSIX standard headers
 #ifndef _WIN32
@@ -30,196 +31,146 @@
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 39)
 #define HAVE_SYSCALL_CLOCK_BOOTTIME
 #endif // LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 39)
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 0, 0) && defined(CLOCK_BOOTTIME_ALARM)
+#define HAVE_SYSCALL_CLOCK_REALTIME_ALARM
+#define HAVE_SYSCALL_CLOCK_BOOTTIME_ALARM
+#endif // LINUX_VERSION_CODE >= KERNEL_VERSION(3, 0, 0) && defined(CLOCK_BOOTTIME_ALARM)
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 10, 0) && defined(CLOCK_TAI)
+#define HAVE_SYSCALL_CLOCK_TAI
+#endif // LINUX_VERSION_CODE >= KERNEL_VERSION(3, 10, 0) && defined(CLOCK_TAI)
+
+// the clocks that exist in all the kernels the HAVE_SYSCALL_CLOCK_* checks accept, whose
+// is_available is a constant; the others are only known to be available if they can be read
+template <clockid_t Id>
+struct syscall_clock_always_available : public std::false_type { };
+
+template <> struct syscall_clock_always_available<CLOCK_REALTIME> : public std::true_type { };
+template <> struct syscall_clock_always_available<CLOCK_MONOTONIC> : public std::true_type { };
+template <> struct syscall_clock_always_available<CLOCK_PROCESS_CPUTIME_ID> : public std::true_type { };
+template <> struct syscall_clock_always_available<CLOCK_THREAD_CPUTIME_ID> : public std::true_type { };
 
-#ifdef HAVE_SYSCALL_CLOCK_REALTIME
-// based on syscall(SYS_clock_gettime, CLOCK_REALTIME, ...)
-struct clock_syscall_realtime
+#ifdef HAVE_SYSCALL_CLOCK_MONOTONIC_RAW
+template <> struct syscall_clock_always_available<CLOCK_MONOTONIC_RAW> : public std::true_type { };
+#endif // HAVE_SYSCALL_CLOCK_MONOTONIC_RAW
+
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME_COARSE
+template <> struct syscall_clock_always_available<CLOCK_REALTIME_COARSE> : public std::true_type { };
+template <> struct syscall_clock_always_available<CLOCK_MONOTONIC_COARSE> : public std::true_type { };
+#endif // HAVE_SYSCALL_CLOCK_REALTIME_COARSE
+
+#ifdef HAVE_SYSCALL_CLOCK_BOOTTIME
+template <> struct syscall_clock_always_available<CLOCK_BOOTTIME> : public std::true_type { };
+#endif // HAVE_SYSCALL_CLOCK_BOOTTIME
+
+
+// based on syscall(SYS_clock_gettime, Id, ...), for any clock id known at compile time
+//
+// Like posix_clock, is_available is a constant for the clocks that are always available, and
+// available() returns the same value at any time, also during the dynamic initialisation.
+template <clockid_t Id, bool Steady>
+struct syscall_clock
 {
   typedef std::chrono::nanoseconds                                      duration;
   typedef duration::rep                                                 rep;
   typedef duration::period                                              period;
-  typedef std::chrono::time_point<clock_syscall_realtime, duration>     time_point;
+  typedef std::chrono::time_point<syscall_clock, duration>              time_point;
+
+  static constexpr clockid_t id        = Id;
+  static constexpr bool      is_steady = Steady;
+  static const     bool      is_available;
 
-  static constexpr bool is_steady = false;
-  static const     bool is_available;
+  static bool available() noexcept;
 
   static time_point now() noexcept
   {
     timespec t;
-    syscall(SYS_clock_gettime, CLOCK_REALTIME, &t);
+    syscall(SYS_clock_gettime, Id, &t);
 
     return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
   }
 
 };
-#endif // HAVE_SYSCALL_CLOCK_REALTIME
-
 
-#ifdef HAVE_SYSCALL_CLOCK_REALTIME_COARSE
-// based on syscall(SYS_clock_gettime, CLOCK_REALTIME_COARSE, ...)
-struct clock_syscall_realtime_coarse
+// check if a clock can be read with the system call
+inline bool syscall_clock_is_available(clockid_t id) noexcept
 {
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_syscall_realtime_coarse, duration>  time_point;
+  timespec t;
+  return syscall(SYS_clock_gettime, id, &t) == 0;
+}
 
-  static constexpr bool is_steady = false;
-  static const     bool is_available;
+template <clockid_t Id, bool Steady>
+constexpr clockid_t syscall_clock<Id, Steady>::id;
 
-  static time_point now() noexcept
-  {
-    timespec t;
-    syscall(SYS_clock_gettime, CLOCK_REALTIME_COARSE, &t);
+template <clockid_t Id, bool Steady>
+constexpr bool syscall_clock<Id, Steady>::is_steady;
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
+template <clockid_t Id, bool Steady>
+bool syscall_clock<Id, Steady>::available() noexcept
+{
+  static const bool value = syscall_clock_always_available<Id>::value || syscall_clock_is_available(Id);
+  return value;
+}
 
-};
-#endif // HAVE_SYSCALL_CLOCK_REALTIME_COARSE
+// a constant expression for the clocks that are always available, as the call is not evaluated
+template <clockid_t Id, bool Steady>
+const bool syscall_clock<Id, Steady>::is_available = syscall_clock_always_available<Id>::value || syscall_clock<Id, Steady>::available();
 
 
-#ifdef HAVE_SYSCALL_CLOCK_MONOTONIC
-// based on syscall(SYS_clock_gettime, CLOCK_MONOTONIC, ...)
-struct clock_syscall_monotonic
-{
-  typedef std::chrono::nanoseconds                                      duration;
-  typedef duration::rep                                                 rep;
-  typedef duration::period                                              period;
-  typedef std::chrono::time_point<clock_syscall_monotonic, duration>    time_point;
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME
+// based on syscall(SYS_clock_gettime, CLOCK_REALTIME, ...)
+typedef syscall_clock<CLOCK_REALTIME, false>                     clock_syscall_realtime;
+#endif // HAVE_SYSCALL_CLOCK_REALTIME
 
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME_COARSE
+// based on syscall(SYS_clock_gettime, CLOCK_REALTIME_COARSE, ...)
+typedef syscall_clock<CLOCK_REALTIME_COARSE, false>              clock_syscall_realtime_coarse;
+#endif // HAVE_SYSCALL_CLOCK_REALTIME_COARSE
 
-  static time_point now() noexcept
-  {
-    timespec t;
-    syscall(SYS_clock_gettime, CLOCK_MONOTONIC, &t);
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME_ALARM
+// based on syscall(SYS_clock_gettime, CLOCK_REALTIME_ALARM, ...)
+typedef syscall_clock<CLOCK_REALTIME_ALARM, false>               clock_syscall_realtime_alarm;
+#endif // HAVE_SYSCALL_CLOCK_REALTIME_ALARM
 
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
+#ifdef HAVE_SYSCALL_CLOCK_TAI
+// based on syscall(SYS_clock_gettime, CLOCK_TAI, ...)
+typedef syscall_clock<CLOCK_TAI, false>                          clock_syscall_tai;
+#endif // HAVE_SYSCALL_CLOCK_TAI
 
-};
+#ifdef HAVE_SYSCALL_CLOCK_MONOTONIC
+// based on syscall(SYS_clock_gettime, CLOCK_MONOTONIC, ...)
+typedef syscall_clock<CLOCK_MONOTONIC, true>                     clock_syscall_monotonic;
 #endif // HAVE_SYSCALL_CLOCK_MONOTONIC
 
-
 #ifdef HAVE_SYSCALL_CLOCK_MONOTONIC_COARSE
 // based on syscall(SYS_clock_gettime, CLOCK_MONOTONIC_COARSE, ...)
-struct clock_syscall_monotonic_coarse
-{
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_syscall_monotonic_coarse, duration> time_point;
-
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
-
-  static time_point now() noexcept
-  {
-    timespec t;
-    syscall(SYS_clock_gettime, CLOCK_MONOTONIC_COARSE, &t);
-
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
-
-};
+typedef syscall_clock<CLOCK_MONOTONIC_COARSE, true>              clock_syscall_monotonic_coarse;
 #endif // HAVE_SYSCALL_CLOCK_MONOTONIC_COARSE
 
-
 #ifdef HAVE_SYSCALL_CLOCK_MONOTONIC_RAW
 // based on syscall(SYS_clock_gettime, CLOCK_MONOTONIC_RAW, ...)
-struct clock_syscall_monotonic_raw
-{
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_syscall_monotonic_raw, duration>    time_point;
-
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
-
-  static inline time_point now() noexcept
-  {
-    timespec t;
-    syscall(SYS_clock_gettime, CLOCK_MONOTONIC_RAW, &t);
-
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
-
-};
+typedef syscall_clock<CLOCK_MONOTONIC_RAW, true>                 clock_syscall_monotonic_raw;
 #endif // HAVE_SYSCALL_CLOCK_MONOTONIC_RAW
 
-
 #ifdef HAVE_SYSCALL_CLOCK_BOOTTIME
 // based on syscall(SYS_clock_gettime, CLOCK_BOOTTIME, ...)
-struct clock_syscall_boottime
-{
-  typedef std::chrono::nanoseconds                                          duration;
-  typedef duration::rep                                                     rep;
-  typedef duration::period                                                  period;
-  typedef std::chrono::time_point<clock_syscall_boottime, duration>         time_point;
-
-  static constexpr bool is_steady = true;
-  static const     bool is_available;
-
-  static inline time_point now() noexcept
-  {
-    timespec t;
-    syscall(SYS_clock_gettime, CLOCK_BOOTTIME, &t);
-
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
-
-};
+typedef syscall_clock<CLOCK_BOOTTIME, true>                      clock_syscall_boottime;
 #endif // HAVE_SYSCALL_CLOCK_BOOTTIME
 
+#ifdef HAVE_SYSCALL_CLOCK_BOOTTIME_ALARM
+// based on syscall(SYS_clock_gettime, CLOCK_BOOTTIME_ALARM, ...)
+typedef syscall_clock<CLOCK_BOOTTIME_ALARM, true>                clock_syscall_boottime_alarm;
+#endif // HAVE_SYSCALL_CLOCK_BOOTTIME_ALARM
 
 #ifdef HAVE_SYSCALL_CLOCK_PROCESS_CPUTIME_ID
 // based on syscall(SYS_clock_gettime, CLOCK_PROCESS_CPUTIME_ID, ...)
-struct clock_syscall_process_cputime
-{
-  typedef std::chrono::nanoseconds                                              duration;
-  typedef duration::rep                                                         rep;
-  typedef duration::period                                                      period;
-  typedef std::chrono::time_point<clock_syscall_process_cputime, duration>      time_point;
-
-  static constexpr bool is_steady = false;  // FIXME can this be considered "steady" ?
-  static const     bool is_available;
-
-  static time_point now() noexcept
-  {
-    timespec t;
-    syscall(SYS_clock_gettime, CLOCK_PROCESS_CPUTIME_ID, &t);
-
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
-
-};
+// FIXME can this be considered "steady" ?
+typedef syscall_clock<CLOCK_PROCESS_CPUTIME_ID, false>           clock_syscall_process_cputime;
 #endif // HAVE_SYSCALL_CLOCK_PROCESS_CPUTIME_ID
 
-
 #ifdef HAVE_SYSCALL_CLOCK_THREAD_CPUTIME_ID
 // based on syscall(SYS_clock_gettime, CLOCK_THREAD_CPUTIME_ID, ...)
-struct clock_syscall_thread_cputime
-{
-  typedef std::chrono::nanoseconds                                              duration;
-  typedef duration::rep                                                         rep;
-  typedef duration::period                                                      period;
-  typedef std::chrono::time_point<clock_syscall_thread_cputime, duration>       time_point;
-
-  static constexpr bool is_steady = false;  // FIXME can this be considered "steady" ?
-  static const     bool is_available;
-
-  static time_point now() noexcept
-  {
-    timespec t;
-    syscall(SYS_clock_gettime, CLOCK_THREAD_CPUTIME_ID, &t);
-
-    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
-  }
-
-};
+// FIXME can this be considered "steady" ?
+typedef syscall_clock<CLOCK_THREAD_CPUTIME_ID, false>            clock_syscall_thread_cputime;
 #endif // HAVE_SYSCALL_CLOCK_THREAD_CPUTIME_ID
 
 #endif // __linux__
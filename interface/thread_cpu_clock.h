@@ -0,0 +1,135 @@
+#ifndef thread_cpu_clock_h
+#define thread_cpu_clock_h
+
+// C++ standard headers
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "interface/posix_clock_gettime.h"
+
+#ifdef HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+#define HAVE_THREAD_CPU_CLOCK
+
+// the cpu time of any thread of the process, based on clock_gettime() with the clock id returned by
+// pthread_getcpuclockid(); unlike clock_gettime_thread_cputime and clock_getrusage_thread, it can be
+// read from a different thread than the one it measures
+//
+// The clock id is only valid until the thread has been joined or, for a detached thread, until it
+// has terminated. Reading it after that is undefined: on Linux the id encodes the thread id, so it
+// may fail (and now() returns the epoch), but it may also read the cpu time of an unrelated thread
+// that has been given the same thread id in the meantime.
+struct thread_cpu_clock
+{
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<thread_cpu_clock, duration>           time_point;
+
+  static constexpr bool is_steady = false;
+
+  explicit thread_cpu_clock(pthread_t thread) noexcept :
+    clock_(dynamic_posix_clock::thread_cputime(thread))
+  { }
+
+  // the cpu time clock of the calling thread
+  static thread_cpu_clock self() noexcept
+  {
+    return thread_cpu_clock(pthread_self());
+  }
+
+  clockid_t id() const noexcept
+  {
+    return clock_.id();
+  }
+
+  bool is_available() const noexcept
+  {
+    return clock_.is_available();
+  }
+
+  time_point now() const noexcept
+  {
+    timespec t;
+    if (! is_available() || clock_gettime(clock_.id(), &t) != 0)
+      return time_point();
+
+    return time_point( std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec) );
+  }
+
+private:
+  dynamic_posix_clock clock_;
+};
+
+
+// the cpu time of a pool of threads, read by a supervisor thread in a single pass
+//
+// The threads are registered once, from any thread; each call to sample() then reads the cpu time
+// clock of every registered thread, between two readings of CLOCK_MONOTONIC, into a snapshot whose
+// storage is reused from one call to the next. The utilisation of each thread over an interval is
+// the cpu time it used between two snapshots, divided by the wall-clock time between them.
+//
+// A thread must be removed from the sampler before it is joined (or, if it is detached, before it
+// terminates), for the reasons given for thread_cpu_clock; the indices of the other threads do not
+// change, and the slot of a removed thread reads as -1 from then on.
+//
+// A sample costs one clock_gettime() per thread: the cpu time of another thread is not exported
+// through the vDSO, so each read is a system call.
+struct thread_cpu_sampler
+{
+  struct snapshot {
+    int64_t              begin;         // CLOCK_MONOTONIC before the first thread was read, in ns
+    int64_t              end;           // CLOCK_MONOTONIC after the last thread was read, in ns
+    std::vector<int64_t> cpu_time;      // cpu time of each registered thread in ns, or -1 if it could not be read
+  };
+
+  // register a thread, and return its index in the snapshots; a thread whose clock is not
+  // available is registered anyway, and always reads as -1
+  size_t add(pthread_t thread);
+
+  // register the calling thread
+  size_t add_self()
+  {
+    return add(pthread_self());
+  }
+
+  // unregister the thread at the given index, which must be done before the thread is joined;
+  // the index is not reused
+  void remove(size_t index);
+
+  // number of slots in the snapshots, including those of the threads that have been removed
+  size_t size() const;
+
+  // read the cpu time of all the registered threads
+  void sample(snapshot & result) const;
+
+  snapshot sample() const
+  {
+    snapshot result;
+    sample(result);
+    return result;
+  }
+
+  // the fraction of the interval between the two snapshots during which each thread was running,
+  // measured between the midpoints of the two passes; NaN for the threads that could not be read
+  // in either snapshot (e.g. because they had been removed), or that were registered after the
+  // first one
+  static void utilization(snapshot const & first, snapshot const & second, std::vector<double> & result);
+
+  static std::vector<double> utilization(snapshot const & first, snapshot const & second)
+  {
+    std::vector<double> result;
+    utilization(first, second, result);
+    return result;
+  }
+
+private:
+  mutable std::mutex            mutex_;
+  std::vector<thread_cpu_clock> clocks_;
+  std::vector<bool>             removed_;
+};
+
+#endif // HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+
+#endif // thread_cpu_clock_h
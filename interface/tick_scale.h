@@ -0,0 +1,58 @@
+#ifndef tick_scale_h
+#define tick_scale_h
+
+// C++ standard headers
+#include <cstdint>
+
+// MSVC doesn't have an __int128_t type, use abseil's version
+#ifdef _MSC_VER
+#include <absl/numeric/int128.h>
+typedef absl::int128 __int128_t;
+#endif
+
+
+// conversion constants of a clock whose tick rate is only known at run time (e.g. sysconf(_SC_CLK_TCK))
+//
+// A tick_scale should be defined once, as a constant initialised at program startup, rather than
+// as a set of function-local statics: the clocks then read the constants directly, without checking
+// the guard of the thread-safe initialisation on every call, and their now() can be inlined.
+struct tick_scale {
+  int64_t ticks_per_second;
+  double  seconds_per_tick;
+  int64_t nanoseconds_multiplier;               // the nanoseconds per tick are multiplier / divisor,
+  int64_t nanoseconds_divisor;                  // with a divisor of 1 if a tick is a whole number of nanoseconds
+  int64_t nanoseconds_per_tick_shifted;         // shifted left by 32 bits
+  bool    exact;                                // a tick is a whole number of nanoseconds
+
+  static constexpr tick_scale from_ticks_per_second(int64_t ticks_per_second) noexcept
+  {
+    return tick_scale {
+      ticks_per_second,
+      1. / (double) ticks_per_second,
+      (1000000000ll % ticks_per_second) == 0 ? 1000000000ll / ticks_per_second : 1000000000ll,
+      (1000000000ll % ticks_per_second) == 0 ? 1 : ticks_per_second,
+      (int64_t) ((1000000000ull << 32) / (uint64_t) ticks_per_second),
+      (1000000000ll % ticks_per_second) == 0
+    };
+  }
+
+  // the ratio is chosen when the scale is built, so the conversion does not branch on it; the
+  // division by 1 of an exact ratio is cheap on the current CPUs, compared to the clocks that use it
+  int64_t to_nanoseconds(int64_t ticks) const noexcept
+  {
+    return ticks * nanoseconds_multiplier / nanoseconds_divisor;
+  }
+
+  // multiply by the fixed point ratio, with a 128-bit product
+  int64_t to_nanoseconds_fixed(int64_t ticks) const noexcept
+  {
+    return (int64_t) (((__int128_t) ticks * nanoseconds_per_tick_shifted) >> 32);
+  }
+
+  double to_seconds(double ticks) const noexcept
+  {
+    return ticks * seconds_per_tick;
+  }
+};
+
+#endif // tick_scale_h
@@ -0,0 +1,124 @@
+#ifndef vdso_clock_h
+#define vdso_clock_h
+
+// C++ standard headers
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// POSIX standard headers
+#include <time.h>
+
+#include "interface/x86_tsc.h"
+
+#if defined(__linux__) && defined(__x86_64__) && defined(__GNUC__)
+#define HAVE_VDSO_CLOCK
+#endif
+
+#ifdef HAVE_VDSO_CLOCK
+
+// Location of the clock data that the kernel publishes in the vDSO data page ([vvar]), and that
+// the vDSO uses to implement clock_gettime():
+//
+//   struct vdso_clock {                        // struct vdso_data before Linux 6.13
+//     u32 seq;                                 // sequence count, odd while being updated
+//     s32 clock_mode;                          // 1 if the clocksource is the TSC
+//     u64 cycle_last;
+//     u64 max_cycles;                          // only with CONFIG_GENERIC_VDSO_OVERFLOW_PROTECT
+//     u64 mask;
+//     u32 mult;
+//     u32 shift;
+//     struct { u64 sec; u64 nsec; } basetime[];  // indexed by clock id, nsec shifted left by shift
+//   };
+//
+// The layout is not an ABI: the known variants are only used after checking that they give the
+// same values as clock_gettime().
+struct vdso_clock_layout {
+  const volatile uint8_t * data;                // nullptr if the clock data could not be located
+  uint32_t                 extra;               // 8 if the layout includes max_cycles, 0 otherwise
+};
+
+// read CLOCK_MONOTONIC with the same steps and the same arithmetic as the vDSO, so that the result
+// is identical to clock_gettime(); return false if the layout is not valid, or if the clocksource is
+// not the TSC (e.g. it was changed after the program started)
+inline bool read_vdso_monotonic(vdso_clock_layout const & layout, int64_t & ns) noexcept
+{
+  const volatile uint8_t * vc = layout.data;
+  if (vc == nullptr)
+    return false;
+
+  const uint32_t offset = layout.extra;
+  const uint32_t basetime = 32 + offset + 16 * CLOCK_MONOTONIC;
+  uint32_t seq;
+  uint64_t sec;
+  uint64_t nsec;
+  do {
+    // wait for the writer to complete an update
+    while ((seq = * (const volatile uint32_t *) vc) & 1)
+      _mm_pause();
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    if (* (const volatile int32_t *) (vc + 4) != 1)
+      return false;
+
+    // like the kernel's rdtsc_ordered(), do not let the TSC be read before the sequence count
+    _mm_lfence();
+    uint64_t cycles = rdtsc();
+    uint64_t last   = * (const volatile uint64_t *) (vc + 8);
+    uint32_t mult   = * (const volatile uint32_t *) (vc + 24 + offset);
+    uint32_t shift  = * (const volatile uint32_t *) (vc + 28 + offset);
+    uint64_t base   = * (const volatile uint64_t *) (vc + basetime + 8);
+    sec             = * (const volatile uint64_t *) (vc + basetime);
+
+    // a TSC value behind cycle_last (e.g. read on a different CPU) does not move the time backwards
+    uint64_t delta  = cycles > last ? cycles - last : 0;
+    if (offset != 0 && delta >= * (const volatile uint64_t *) (vc + 16))
+      nsec = (uint64_t) (((unsigned __int128) delta * mult + base) >> shift);
+    else
+      nsec = (delta * mult + base) >> shift;
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+  } while (* (const volatile uint32_t *) vc != seq);
+
+  ns = (int64_t) (sec * 1000000000ull + nsec);
+  return true;
+}
+
+// CLOCK_MONOTONIC, read inline from the vDSO data page instead of calling the vDSO
+//
+// The data is located once, when the program starts; the clock falls back to clock_gettime() if
+// the layout of the page is not recognised, if the process runs in a time namespace, or whenever
+// the clocksource is not the TSC.
+struct clock_vdso_monotonic
+{
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<clock_vdso_monotonic, duration>       time_point;
+
+  static constexpr bool is_steady    = true;
+  static constexpr bool is_available = true;
+
+  // true if the clock data was located, and the time can be read in user space
+  static bool is_direct() noexcept
+  {
+    return layout.data != nullptr;
+  }
+
+  static time_point now() noexcept
+  {
+    int64_t ns;
+    if (!read_vdso_monotonic(layout, ns)) {
+      timespec t;
+      clock_gettime(CLOCK_MONOTONIC, &t);
+      ns = (int64_t) t.tv_sec * 1000000000ll + t.tv_nsec;
+    }
+    return time_point(duration(ns));
+  }
+
+private:
+  // zero-initialised, so the clock falls back to clock_gettime() until it is set
+  static const vdso_clock_layout layout;
+};
+
+#endif // HAVE_VDSO_CLOCK
+
+#endif // vdso_clock_h
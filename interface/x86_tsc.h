@@ -1,6 +1,7 @@
 #ifndef x86_tsc_h
 #define x86_tsc_h
 
+#include <chrono>
 #include <cstdint>
 
 #if defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_AMD64) || (defined(_WIN32) && defined(_M_ARM64))
@@ -30,6 +31,19 @@ extern inline uint64_t rdtscp(uint32_t *aux)
 {
     return __rdtscp(aux);
 }
+
+#ifdef CHRONO_HAVE_X86_INTRINSICS
+#define CHRONO_HAVE_RDPID
+
+// read IA32_TSC_AUX without reading the TSC; written in assembly, so that it does not require
+// building the whole program for a processor that supports it
+extern inline uint32_t rdpid(void)
+{
+    uintptr_t aux;
+    __asm__ __volatile__ ("rdpid %0" : "=r" (aux));
+    return (uint32_t) aux;
+}
+#endif // CHRONO_HAVE_X86_INTRINSICS
 #elif defined(_MSC_VER)
 #include <intrin.h>
 
@@ -62,6 +76,14 @@ extern inline uint64_t rdtscp(uint32_t *aux)
 {
     return __rdtscp(aux);
 }
+
+#define CHRONO_HAVE_RDPID
+
+// read IA32_TSC_AUX without reading the TSC
+extern inline uint32_t rdpid(void)
+{
+    return _rdpid_u32();
+}
 #endif
 #else
 #  error "Unsupported compiler"
@@ -69,11 +91,52 @@ extern inline uint64_t rdtscp(uint32_t *aux)
 
 bool has_tsc();
 bool has_rdtscp();
+bool has_rdpid();
 bool has_invariant_tsc();
 bool tsc_allowed();
 
+// where the TSC frequency was read from, from the most to the least accurate
+enum class tsc_frequency_source {
+  none,                 // the TSC is not available
+  perf_event,           // conversion parameters used by the kernel, read from the perf_event mmap page
+  cpuid_crystal,        // CPUID leaf 0x15, crystal clock frequency and TSC / crystal ratio
+  kernel,               // frequency exported by the kernel (e.g. tsc_freq_khz in sysfs)
+  hypervisor,           // CPUID leaf 0x40000010, TSC frequency reported by the hypervisor
+  cpuid_base,           // CPUID leaf 0x16, nominal processor base frequency (1 MHz granularity, error unknown)
+  calibration           // measured by calibrate_tsc()
+};
+
+const char * tsc_frequency_source_name(tsc_frequency_source source);
+
+// TSC frequency, and its estimated precision
+struct tsc_calibration {
+  double               hz;
+  double               error_ppm;       // estimated relative error, in parts per million; NaN if unknown
+  tsc_frequency_source source;
+};
+
+// a TSC value and the corresponding time of the reference clock (CLOCK_MONOTONIC_RAW where available)
+struct tsc_sample {
+  int64_t  nanoseconds;                 // reference clock
+  uint64_t ticks;                       // midpoint of the TSC reads around the reference clock
+  uint64_t bracket;                     // distance between the TSC reads
+};
+
+// read the reference clock between two reads of the TSC, and keep the narrowest of a few attempts
+tsc_sample sample_tsc(unsigned int attempts = 8);
+
+// same, using a different reference clock, that returns its time in nanoseconds
+tsc_sample sample_tsc(int64_t (*reference)(), unsigned int attempts = 8);
+
+// calibrate the TSC until the estimated error is below target_ppm, or for at most max_time
+tsc_calibration calibrate_tsc(double target_ppm = 1., std::chrono::milliseconds max_time = std::chrono::milliseconds(1000));
+
+// calibrate the TSC with the default precision and time limit, and return its frequency
 double calibrate_tsc_hz();
 
+// read the TSC frequency from the first available source, and fall back to calibrate_tsc()
+tsc_calibration discover_tsc_frequency(double target_ppm = 1., std::chrono::milliseconds max_time = std::chrono::milliseconds(1000));
+
 
 // IFUNC support requires GCC >= 4.6.0 and GLIBC >= 2.11.1
 #if ( defined __GNUC__ && (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) ) \
@@ -0,0 +1,48 @@
+#ifndef x86_tsc_cache_h
+#define x86_tsc_cache_h
+
+// C++ standard headers
+#include <string>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+
+#if defined(CHRONO_HAVE_TSC) && defined(__linux__)
+#define CHRONO_HAVE_TSC_CACHE
+#endif
+
+#ifdef CHRONO_HAVE_TSC_CACHE
+
+// Opt-in on-disk cache of the TSC calibration.
+//
+// The tsc_tick parameters are computed once per boot and stored in a file, that later processes
+// map and reuse instead of calibrating the TSC again. Each entry is keyed on the kernel boot id,
+// the CPUID vendor and signature (family, model and stepping) and the current clocksource;
+// entries with a different key, or that are corrupted, are ignored and replaced.
+//
+// The parameters read from the perf_event mmap page are never cached: they are cheap to read, and
+// their time_zero changes across a suspend and resume within the same boot. A cache file is only
+// used if it is a regular file owned by the effective user, and not writable by group or others.
+//
+// The cache is enabled by setting the CHRONO_TSC_CACHE environment variable to the path of the
+// cache file, or to "1" to use $XDG_RUNTIME_DIR/chrono-tsc.cache; or by calling enable_tsc_cache()
+// before the TSC is calibrated. Without XDG_RUNTIME_DIR there is no default location, and "1"
+// leaves the cache disabled.
+
+// enable the cache, using the given file or the default location if the path is empty
+void enable_tsc_cache(std::string const & path = std::string());
+
+// return the path of the cache file, or an empty string if the cache is not enabled
+std::string tsc_cache_path();
+
+// read the parameters from the cache file; return false if the file is missing, stale, invalid or
+// could have been written by another user
+bool read_tsc_cache(std::string const & path, tsc_tick::parameters & p);
+
+// write the parameters to the cache file, atomically replacing any previous entry; the parameters
+// read from the perf_event mmap page are not written
+bool write_tsc_cache(std::string const & path, tsc_tick::parameters const & p);
+
+#endif // CHRONO_HAVE_TSC_CACHE
+
+#endif // x86_tsc_cache_h
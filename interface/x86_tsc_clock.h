@@ -7,6 +7,11 @@
 // for tsc_tick, etc.
 #include "interface/x86_tsc.h"
 #include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_realtime.h"
+#include "interface/x86_tsc_monotonic.h"
+#include "interface/x86_tsc_coarse.h"
+#include "interface/x86_tsc_sync.h"
+#include "interface/x86_tsc_cpu.h"
 
 #ifdef CHRONO_HAVE_X86_INTRINSICS
 // for rdtscp, rdtscp, lfence, mfence
@@ -28,7 +33,7 @@ struct clock_rdtsc
   static time_point now() noexcept
   {
     int64_t    ticks = rdtsc();
-    rep        ns    = tsc_tick::to_nanoseconds(ticks);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
     time_point time  = time_point(duration(ns));
     return time;
   }
@@ -55,7 +60,7 @@ struct clock_rdtsc_lfence
     __dmb(_ARM64_BARRIER_SY);
 #endif
     int64_t    ticks = rdtsc();
-    rep        ns    = tsc_tick::to_nanoseconds(ticks);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
     time_point time  = time_point(duration(ns));
     return time;
   }
@@ -81,7 +86,7 @@ struct clock_rdtsc_mfence
     __dmb(_ARM64_BARRIER_SY);
 #endif
     int64_t    ticks = rdtsc();
-    rep        ns    = tsc_tick::to_nanoseconds(ticks);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
     time_point time  = time_point(duration(ns));
     return time;
   }
@@ -105,7 +110,95 @@ struct clock_rdtscp
   {
     unsigned int id;
     int64_t    ticks = rdtscp(& id);
-    rep        ns    = tsc_tick::to_nanoseconds(ticks);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
+    time_point time  = time_point(duration(ns));
+    return time;
+  }
+};
+#endif
+
+#ifdef CHRONO_HAVE_RDTSCP
+// TSC-based clock, using rdtscp as serialising instruction, that can also return the CPU and NUMA
+// node the TSC was read on
+struct clock_rdtscp_cpu
+{
+  // std::chrono interface
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<clock_rdtscp_cpu, duration>           time_point;
+
+  static const bool is_steady;
+  static const bool is_available;
+
+  static time_point now() noexcept
+  {
+    tsc_aux aux;
+    return now(aux);
+  }
+
+  // also return the CPU and node the TSC was read on
+  static time_point now(tsc_aux & aux) noexcept
+  {
+    int64_t    ticks = rdtscp(& aux.value);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
+    time_point time  = time_point(duration(ns));
+    return time;
+  }
+};
+#endif
+
+#ifdef CHRONO_HAVE_RDPID
+// TSC-based clock, using rdtsc (non-serialising) between two rdpid, that can also return the CPU
+// and NUMA node the TSC was read on
+struct clock_rdpid_cpu
+{
+  // std::chrono interface
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<clock_rdpid_cpu, duration>            time_point;
+
+  static const bool is_steady;
+  static const bool is_available;
+
+  static time_point now() noexcept
+  {
+    tsc_aux aux;
+    return now(aux);
+  }
+
+  // also return the CPU and node the TSC was read on
+  static time_point now(tsc_aux & aux) noexcept
+  {
+    int64_t    ticks = rdtsc_rdpid(& aux.value);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
+    time_point time  = time_point(duration(ns));
+    return time;
+  }
+};
+#endif
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+// TSC-based clock, using rdtscp as serialising instruction, and subtracting the offset of the CPU it
+// was read on, so that the values from different CPUs share the same timeline; the offsets are
+// measured by tsc_cpu_offsets::measure()
+struct clock_rdtscp_compensated
+{
+  // std::chrono interface
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<clock_rdtscp_compensated, duration>   time_point;
+
+  static const bool is_steady;
+  static const bool is_available;
+
+  static time_point now() noexcept
+  {
+    unsigned int id;
+    int64_t    ticks = rdtscp(& id) - tsc_cpu_offsets::get(id);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
     time_point time  = time_point(duration(ns));
     return time;
   }
@@ -127,11 +220,80 @@ struct clock_serialising_rdtsc
   static time_point now() noexcept
   {
     int64_t    ticks = serialising_rdtsc();
-    rep        ns    = tsc_tick::to_nanoseconds(ticks);
+    rep        ns    = tsc_tick::to_timestamp(ticks);
+    time_point time  = time_point(duration(ns));
+    return time;
+  }
+};
+
+// TSC-based wall-clock time, using rdtsc (non-serialising) and an offset from CLOCK_REALTIME
+// re-anchored periodically; see tsc_realtime for the error between two resyncs
+struct clock_tsc_realtime
+{
+  // std::chrono interface
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<clock_tsc_realtime, duration>         time_point;
+
+  static const bool is_steady;
+  static const bool is_available;
+
+  static time_point now() noexcept
+  {
+    int64_t    ticks = rdtsc();
+    rep        ns    = tsc_tick::to_timestamp(ticks) + tsc_realtime::get(ticks).offset_nanoseconds;
+    time_point time  = time_point(duration(ns));
+    return time;
+  }
+};
+
+// TSC-based clock, using rdtsc (non-serialising) and slewed to follow CLOCK_MONOTONIC, including
+// the NTP frequency adjustments; see tsc_monotonic for how the correction is applied, and why the
+// values may be out of order around a resync
+struct clock_tsc_monotonic
+{
+  // std::chrono interface
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<clock_tsc_monotonic, duration>        time_point;
+
+  static const bool is_steady;
+  static const bool is_available;
+
+  static time_point now() noexcept
+  {
+    int64_t    ticks = rdtsc();
+    rep        ns    = tsc_monotonic::to_nanoseconds(ticks);
+    time_point time  = time_point(duration(ns));
+    return time;
+  }
+};
+
+#ifdef HAVE_TSC_COARSE
+// CLOCK_MONOTONIC_COARSE, interpolated in between its updates with the TSC (non-serialising),
+// and clamped below its next update; see tsc_coarse for how the anchors are taken.
+// It never goes backwards within a thread, but is not steady across threads.
+struct clock_tsc_coarse
+{
+  // std::chrono interface
+  typedef std::chrono::nanoseconds                                      duration;
+  typedef duration::rep                                                 rep;
+  typedef duration::period                                              period;
+  typedef std::chrono::time_point<clock_tsc_coarse, duration>           time_point;
+
+  static const bool is_steady;
+  static const bool is_available;
+
+  static time_point now() noexcept
+  {
+    rep        ns    = tsc_coarse::now();
     time_point time  = time_point(duration(ns));
     return time;
   }
 };
+#endif // HAVE_TSC_COARSE
 
 
 #endif // x86_tsc_clock_h
@@ -0,0 +1,80 @@
+#ifndef x86_tsc_coarse_h
+#define x86_tsc_coarse_h
+
+// C++ standard headers
+#include <cstdint>
+
+// POSIX standard headers
+#include <time.h>
+
+#include "interface/x86_tsc.h"
+
+#if defined(CHRONO_HAVE_TSC) && defined(CLOCK_MONOTONIC_COARSE)
+#define HAVE_TSC_COARSE
+
+// Interpolation of CLOCK_MONOTONIC_COARSE with the TSC.
+//
+// Each thread keeps an anchor: a TSC value and the time at that value. Between two updates of the
+// coarse clock the time is interpolated from the anchor with the TSC, scaled like tsc_tick, so a
+// call is just rdtsc, a multiply and a shift. The value is clamped below the next update of the
+// coarse clock (its last value plus its resolution), so it never passes a coarse timestamp taken
+// later, and it never goes backwards within a thread. The anchors of different threads are taken
+// at different points of the interpolation, so a value read by one thread can be later than a value
+// read afterwards by another one (by up to the resolution of the coarse clock): the clock is not
+// steady across threads, and a shared high-water mark would cost a contended write at every call.
+//
+// The values follow the time of the coarse clock, not that of CLOCK_MONOTONIC: the coarse clock is
+// updated by the timer tick with the time of the last timekeeping update, so it may lag behind
+// CLOCK_MONOTONIC by more than its resolution. To follow it, each thread locates the updates of the
+// coarse clock in TSC ticks: within a window before the next expected update, the coarse clock is
+// read at every call (and the value stalls at the limit), and the anchor moves to the first call
+// that sees the new value. The window is halved every time the update is found within it, down to
+// 1/64 of the resolution, and doubled when the update happened before it, up to half the
+// resolution; the first anchor of a thread may lag behind the coarse updates by up to one
+// resolution, and converges within a few updates. Outside of the window the interpolation from the
+// previous anchor is kept as long as it stays within the bounds of the coarse clock, so a thread
+// that calls the clock only rarely does not lose the alignment.
+struct tsc_coarse {
+  struct anchor {
+    int64_t  ticks;                             // TSC value at the anchor
+    int64_t  nanoseconds;                       // time at the anchor
+    int64_t  coarse;                            // value of CLOCK_MONOTONIC_COARSE at the anchor
+    uint64_t max_ticks;                         // TSC ticks after the anchor before the window that precedes the next update, 0 if not anchored
+    uint64_t nanoseconds_per_tick_shifted;      // tsc_tick conversion at the anchor
+    int64_t  last;                              // last value returned to the thread
+    int64_t  window;                            // width of the window before the next update, in nanoseconds; 0 if not anchored
+    bool     polling;                           // true if the coarse clock has been read within the current window
+  };
+
+  static int64_t now() noexcept
+  {
+    anchor & a = current();
+    int64_t  ticks = rdtsc();
+    uint64_t delta = (uint64_t) (ticks - a.ticks);
+    if (delta >= a.max_ticks)
+      return resync(a, ticks);
+
+    // the value cannot reach the window before the next coarse update by construction of max_ticks
+    int64_t ns = a.nanoseconds + (int64_t) ((delta * a.nanoseconds_per_tick_shifted) >> 32);
+    if (ns < a.last)
+      ns = a.last;
+    a.last = ns;
+    return ns;
+  }
+
+private:
+  // read the coarse clock within the window before its next update, and move the anchor of the
+  // calling thread when it has been updated
+  static int64_t resync(anchor & a, int64_t ticks) noexcept;
+
+  // zero-initialised, so no guard is needed to access it
+  static anchor & current() noexcept
+  {
+    static thread_local anchor a = {};
+    return a;
+  }
+};
+
+#endif // defined(CHRONO_HAVE_TSC) && defined(CLOCK_MONOTONIC_COARSE)
+
+#endif // x86_tsc_coarse_h
@@ -0,0 +1,65 @@
+#ifndef x86_tsc_cpu_h
+#define x86_tsc_cpu_h
+
+// C++ standard headers
+#include <cstdint>
+
+#include "interface/x86_tsc.h"
+
+#ifdef CHRONO_HAVE_RDTSCP
+
+// IA32_TSC_AUX value of the CPU a TSC value was read on; Linux sets it to (node << 12) | cpu, so a
+// tracer can tell if a thread has migrated between two reads of the TSC without calling sched_getcpu()
+//
+// The clocks that read it return it next to their time point, through now(tsc_aux &), so that their
+// time_point stays a std::chrono::time_point (or native_time_point) of the clock.
+struct tsc_aux
+{
+  uint32_t value;                       // IA32_TSC_AUX value of the CPU
+
+  // CPU the TSC was read on, as reported by sched_getcpu()
+  constexpr uint32_t cpu() const
+  {
+    return value & 0xfff;
+  }
+
+  // NUMA node of that CPU
+  constexpr uint32_t node() const
+  {
+    return value >> 12;
+  }
+
+  // true if the two values were read on the same CPU
+  constexpr bool operator==(tsc_aux const & other) const
+  {
+    return value == other.value;
+  }
+
+  constexpr bool operator!=(tsc_aux const & other) const
+  {
+    return value != other.value;
+  }
+};
+
+#ifdef CHRONO_HAVE_RDPID
+// read the TSC between two reads of IA32_TSC_AUX with rdpid, until both return the same value;
+// a thread can only migrate at an interrupt, so the TSC has been read on that CPU (unless the thread
+// moved away and back within a couple of instructions). Unlike rdtscp, it does not wait for the
+// previous instructions to complete, and is faster where rdpid is available.
+inline uint64_t rdtsc_rdpid(uint32_t * aux)
+{
+  uint32_t before, after;
+  uint64_t ticks;
+  do {
+    before = rdpid();
+    ticks  = rdtsc();
+    after  = rdpid();
+  } while (before != after);
+  *aux = after;
+  return ticks;
+}
+#endif // CHRONO_HAVE_RDPID
+
+#endif // CHRONO_HAVE_RDTSCP
+
+#endif // x86_tsc_cpu_h
@@ -0,0 +1,80 @@
+#ifndef x86_tsc_monotonic_h
+#define x86_tsc_monotonic_h
+
+// C++ standard headers
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/seqlock.h"
+
+// Conversion of TSC values to the time of std::chrono::steady_clock (CLOCK_MONOTONIC), slewed to
+// follow the frequency adjustments applied by NTP or chrony.
+//
+// The conversion is piecewise linear: at every resync (every second by default, done by the first
+// reader that finds the parameters stale) both clocks are sampled, the rate of CLOCK_MONOTONIC with
+// respect to the TSC is measured since the previous sample, and the slope for the next interval is
+// set to that rate plus the correction needed to cancel the current offset by the end of the
+// interval. The correction is limited to +/- 500 ppm, the maximum slew rate used by the kernel.
+// The new segment starts where the previous one ends, keeping the sub-nanosecond part, so the
+// conversion itself never goes backwards; an offset larger than 1 ms is stepped forward instead
+// (e.g. after a suspend), while a clock that is ahead of CLOCK_MONOTONIC is only ever slowed down.
+//
+// The clock is not steady, though: a TSC value read just after the start of a new segment may still
+// be converted with the parameters of the previous one, if they were loaded before the resync was
+// published, and a lower slope (or a step) then gives a later value, converted with the new
+// parameters, an earlier time. The difference is the change of slope times the delay between the
+// two loads, usually well below a nanosecond, but it can be seen both across threads and within one.
+//
+// Once converged the error is dominated by the noise of the samples (a few tens of nanoseconds)
+// plus the change of the NTP frequency over one interval; after a large change it decays within
+// about one interval, at most 500 us per second.
+struct tsc_monotonic {
+  struct parameters {
+    int64_t anchor_ticks;                       // TSC value at the start of the current segment
+    int64_t anchor_nanoseconds;                 // time at the start of the segment, in nanoseconds
+    int64_t anchor_fraction;                    // sub-nanosecond part of the time, in 2^-32 ns
+    int64_t nanoseconds_per_tick_shifted;       // slope of the current segment
+    int64_t previous_nanoseconds_per_tick_shifted; // slope of the previous segment
+    int64_t next_resync;                        // TSC value after which the clocks should be sampled again
+  };
+
+  static int64_t to_nanoseconds(int64_t ticks) noexcept
+  {
+    parameters p;
+    if (params.load(p) == 0 || ticks >= p.next_resync) {
+      resync();
+      // wait for the first measurement, if another thread is doing it
+      while (params.load(p) == 0)
+        resync();
+    }
+    // values read just before a resync are converted with the slope of the previous segment, so
+    // that they are the same as with the previous parameters
+    int64_t    delta   = ticks - p.anchor_ticks;
+    int64_t    slope   = delta >= 0 ? p.nanoseconds_per_tick_shifted : p.previous_nanoseconds_per_tick_shifted;
+    __int128_t shifted = (__int128_t) delta * slope + p.anchor_fraction;
+    return p.anchor_nanoseconds + (int64_t) (shifted >> 32);
+  }
+
+  // sample both clocks and start a new segment, unless another thread is already doing it
+  static void resync() noexcept;
+
+  static void set_resync_interval(std::chrono::nanoseconds interval) noexcept
+  {
+    resync_interval.store(interval.count(), std::memory_order_relaxed);
+  }
+
+  static std::chrono::nanoseconds get_resync_interval() noexcept
+  {
+    return std::chrono::nanoseconds(resync_interval.load(std::memory_order_relaxed));
+  }
+
+private:
+  static seqlock<parameters>  params;
+  static std::atomic_flag     writer;
+  static std::atomic<int64_t> resync_interval;
+};
+
+#endif // x86_tsc_monotonic_h
@@ -0,0 +1,119 @@
+#ifndef x86_tsc_realtime_h
+#define x86_tsc_realtime_h
+
+// C++ standard headers
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/seqlock.h"
+
+// Offset between the TSC and the system (wall-clock) time.
+//
+// The offset is measured by reading std::chrono::system_clock (CLOCK_REALTIME) between two reads
+// of the TSC, and is re-anchored by the first reader that finds it older than the resync interval
+// (100 ms by default), or measured with a TSC frequency that has since been replaced; it is
+// published through a seqlock, so readers never block, and a reader that finds the offset stale
+// while another thread is updating it keeps using the previous value.
+//
+// Between two resyncs the TSC-based time drifts away from CLOCK_REALTIME by at most
+//   (frequency error of tsc_tick + NTP slew rate of CLOCK_REALTIME) * resync interval
+// e.g. (1 ppm + 500 ppm, the kernel's maximum slew rate) * 100 ms ~ 50 us in the worst case, and
+// usually well below 1 us with chrony or ntpd slewing at a few ppm. Steps of CLOCK_REALTIME (e.g.
+// settimeofday) are only picked up at the next resync.
+//
+// tsc_realtime is also the source of tsc_realtime_tick, whose ticks count the wall-clock time since
+// 1970 in units of the TSC period: a TSC value plus offset_ticks. Its scale is the TSC frequency of
+// the first anchor, and never changes, so a time point taken before a refinement of the frequency is
+// still converted to the same time afterwards: a better frequency would move the converted values
+// by its change times the whole time since 1970 (about 1700 s per ppm), while the error of the
+// frozen one only applies between two resyncs, like the drift above. The values overflow at 2^63
+// ticks since 1970: in 2086 for a 2.5 GHz TSC, and in 2043 for a 4 GHz one.
+struct tsc_realtime {
+  struct anchor {
+    int64_t     offset_nanoseconds;   // CLOCK_REALTIME - tsc_tick::to_timestamp(ticks), in nanoseconds
+    int64_t     offset_ticks;         // CLOCK_REALTIME in tsc_realtime_tick units - the TSC value
+    int64_t     next_resync;          // TSC value after which the offset should be measured again
+    uint32_t    generation;           // tsc_tick::generation() when the offset was measured
+    double      ticks_per_second;     // TSC frequency of the first anchor
+    cyc2ns_data cyc2ns;               // conversion of tsc_realtime_tick values to CLOCK_REALTIME, from 1970
+    ns2cyc_data ns2cyc;
+  };
+
+  // return the offset to use for the given TSC value, re-anchoring it if it is stale
+  static anchor get(int64_t ticks) noexcept
+  {
+    anchor a = current();
+    if (ticks >= a.next_resync || a.generation != tsc_tick::generation()) {
+      resync();
+      params.load(a);
+    }
+    return a;
+  }
+
+  // measure the offset again, unless another thread is already doing it
+  static void resync() noexcept;
+
+  static void set_resync_interval(std::chrono::nanoseconds interval) noexcept
+  {
+    resync_interval.store(interval.count(), std::memory_order_relaxed);
+  }
+
+  static std::chrono::nanoseconds get_resync_interval() noexcept
+  {
+    return std::chrono::nanoseconds(resync_interval.load(std::memory_order_relaxed));
+  }
+
+  // interface of a runtime_tick source, for the values of tsc_realtime_tick; the scale is that of
+  // the first anchor, measuring it if it has not been done yet
+  static cyc2ns_data get_cyc2ns() noexcept
+  {
+    return current().cyc2ns;
+  }
+
+  static ns2cyc_data get_ns2cyc() noexcept
+  {
+    return current().ns2cyc;
+  }
+
+  static double ticks_per_second() noexcept
+  {
+    return current().ticks_per_second;
+  }
+
+  static double seconds_per_tick() noexcept
+  {
+    return 1. / current().ticks_per_second;
+  }
+
+  // the scale never changes
+  static uint32_t generation() noexcept
+  {
+    return 1;
+  }
+
+  // the values since 1970 are always too large for a 64-bit multiply, use a 128-bit one
+  static int64_t to_timestamp_far(int64_t ticks) noexcept;
+
+private:
+  // the last anchor, measuring it if it has not been done yet
+  static anchor current() noexcept
+  {
+    anchor a;
+    // wait for the first measurement, if another thread is doing it
+    while (params.load(a) == 0)
+      resync();
+    return a;
+  }
+
+  static seqlock<anchor>      params;
+  static std::atomic_flag     writer;
+  static std::atomic<int64_t> resync_interval;
+};
+
+// the wall-clock time since 1970, in ticks of the TSC with the frequency of the first anchor
+typedef runtime_tick<tsc_realtime> tsc_realtime_tick;
+
+#endif // x86_tsc_realtime_h
@@ -0,0 +1,73 @@
+#ifndef x86_tsc_sync_h
+#define x86_tsc_sync_h
+
+// C++ standard headers
+#include <cstdint>
+#include <vector>
+
+#include "interface/x86_tsc.h"
+
+// the threads are pinned with pthread_setaffinity_np, and the CPU is confirmed with the TSC_AUX
+// value returned by rdtscp, that Linux sets to (node << 12) | cpu
+#if defined(CHRONO_HAVE_RDTSCP) && defined(__linux__)
+#define CHRONO_HAVE_TSC_SYNC
+#endif
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+
+// bounds on the offset between the TSCs of two CPUs, in ticks
+struct tsc_offset_bounds {
+  int64_t  lower;                       // the offset is larger than this value
+  int64_t  upper;                       // the offset is smaller than this value
+  unsigned samples;                     // number of valid round trips used to compute the bounds
+};
+
+// result of check_tsc_sync()
+struct tsc_sync_report {
+  std::vector<int>               cpus;          // CPUs that have been tested
+  std::vector<tsc_offset_bounds> offsets;       // offsets[i * cpus.size() + j] bounds the TSC of cpus[j] minus the TSC of cpus[i]
+  bool                           synchronized;  // all the bounds include 0 (within the tolerance)
+
+  tsc_offset_bounds const & offset(size_t i, size_t j) const {
+    return offsets[i * cpus.size() + j];
+  }
+};
+
+// bound the offset between the TSC of cpu_b and the TSC of cpu_a, with a cache-line ping-pong
+// between two threads pinned to the two CPUs: cpu_a reads its TSC (t1) and notifies cpu_b, that
+// reads its TSC (t2) and replies, then cpu_a reads its TSC again (t3). Since t2 happened between
+// t1 and t3, the offset is within [t2 - t3, t2 - t1]; the tightest bounds over all the rounds are
+// kept, and rounds where rdtscp reports a different CPU are discarded.
+// Return false if the threads could not be pinned, or no round was valid.
+bool measure_tsc_offset(int cpu_a, int cpu_b, unsigned rounds, tsc_offset_bounds & bounds);
+
+// measure the offset between all the pairs of CPUs the process is allowed to run on; the TSCs are
+// considered synchronized if every pair of bounds includes 0, or is within tolerance ticks from it.
+// With a single CPU the report is trivially synchronized.
+tsc_sync_report check_tsc_sync(unsigned rounds = 1000, int64_t tolerance = 0);
+
+// per-CPU TSC offsets, indexed by the CPU number from TSC_AUX, to bring the TSCs of all the CPUs
+// on the timeline of a reference CPU (the first one the process is allowed to run on)
+struct tsc_cpu_offsets {
+  static const unsigned max_cpus = 4096;        // TSC_AUX holds the CPU number in 12 bits
+
+  // offset to subtract from a TSC value read on the CPU reported by rdtscp
+  static int64_t get(uint32_t aux) noexcept
+  {
+    return table[aux & (max_cpus - 1)];
+  }
+
+  // measure the offset of every CPU the process is allowed to run on against the reference CPU,
+  // with measure_tsc_offset(); CPUs whose bounds include 0 are left uncompensated, the others use
+  // the centre of the bounds. Not thread safe with respect to concurrent readers: call it at startup,
+  // before the compensated clocks are used. Return false if some CPU could not be measured.
+  static bool measure(unsigned rounds = 1000);
+
+private:
+  // zero-initialised, so the clocks are uncompensated until measure() is called
+  alignas(64) static int64_t table[max_cpus];
+};
+
+#endif // CHRONO_HAVE_TSC_SYNC
+
+#endif // x86_tsc_sync_h
@@ -2,95 +2,137 @@
 #define x86_tsc_tick_h
 
 // C++ standard headers
+#include <atomic>
 #include <chrono>
-#include <cmath>
+#include <mutex>
 
-// MSVC doesn't have an __int128_t type, use abseil's version
-#ifdef _MSC_VER
-#include <absl/numeric/int128.h>
-typedef absl::int128 __int128_t;
-#endif
+// for tsc_frequency_source
+#include "interface/x86_tsc.h"
+#include "interface/seqlock.h"
+#include "interface/runtime_tick.h"
 
 
-// TSC ticks as clock period
-// XXX should it use unsigned integers ?
-struct tsc_tick {
-  static const double  ticks_per_second;
-  static const double  seconds_per_tick;
-  static const int64_t nanoseconds_per_tick_shifted;
-  static const int64_t ticks_per_nanosecond_shifted;
-
-  static int64_t to_nanoseconds(int64_t ticks) noexcept
+// the TSC, as the source of runtime_tick
+//
+// The TSC frequency is read or calibrated lazily, the first time any of the conversions is used,
+// so that programs that never read the TSC do not pay for the calibration at startup.
+// Long running services can call tsc_tick::calibrate() explicitly to move the cost out
+// of the first measurement.
+//
+// When the kernel exposes its own TSC conversion in the perf_event mmap page, the same
+// parameters are used, and to_timestamp() returns the same values as the perf timestamps.
+//
+// Like the kernel's cyc2ns, the integer conversions read only the few parameters they need; the
+// timestamps are computed relative to an epoch that is moved forward (keeping the sub-nanosecond
+// part, so the results do not change) whenever a TSC value is too far from it, i.e. every few seconds.
+//
+// Otherwise, an optional background thread can keep refining the frequency against
+// CLOCK_MONOTONIC_RAW; the parameters are published through a seqlock, so the conversions
+// never block and never see a partially updated set of parameters.
+struct tsc_counter {
+  struct parameters {
+    double  ticks_per_second;
+    double  seconds_per_tick;
+    int64_t nanoseconds_per_tick_shifted;
+    int64_t ticks_per_nanosecond_shifted;
+    int64_t epoch_ticks;                        // TSC value at the epoch of the timestamps
+    int64_t epoch_nanoseconds;                  // timestamp at the epoch, in nanoseconds
+    int64_t epoch_fraction;                     // sub-nanosecond part of the timestamp at the epoch, in 2^-32 ns
+    uint64_t max_ticks;                         // largest value that to_nanoseconds() converts with a 64-bit multiply
+    uint64_t max_nanoseconds;                   // largest value that from_nanoseconds() converts with a 64-bit multiply
+    double  error_ppm;                          // estimated error of the frequency, NaN if unknown; 0 only for the kernel's parameters
+    tsc_frequency_source source;
+  };
+
+  // calibrate the TSC, if it has not been done yet; safe to call from multiple threads
+  static void calibrate();
+
+  // start a background thread that refines the TSC frequency against CLOCK_MONOTONIC_RAW, taking
+  // a sample every interval; return false if the TSC is not available, or if the parameters come
+  // from the kernel and should not be changed
+  static bool start_refinement(std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
+
+  // stop the refinement thread, if it is running
+  static void stop_refinement();
+
+  static parameters get() noexcept
   {
-    // round the shifted value away from 0, like round() does
-    // XXX should it honor fesetround instead ?
-    __int128_t shifted = (__int128_t) ticks * nanoseconds_per_tick_shifted;
-    __int128_t ns = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
-    return (int64_t) ns;
+    parameters p;
+    if (params.load(p) == 0) {
+      calibrate();
+      params.load(p);
+    }
+    return p;
   }
 
-  static double to_seconds(double ticks) noexcept
+  // subsets of the parameters used by the integer conversions from and to ticks, published separately
+  static cyc2ns_data get_cyc2ns() noexcept
   {
-    return ticks / ticks_per_second;
+    cyc2ns_data c;
+    if (cyc2ns.load(c) == 0) {
+      calibrate();
+      cyc2ns.load(c);
+    }
+    return c;
   }
 
-  static int64_t from_nanoseconds(int64_t ns) noexcept {
-    // round the shifted value away from 0, like round() does
-    // XXX should it honor fesetround instead ?
-    __int128_t shifted = (__int128_t) ns * ticks_per_nanosecond_shifted;
-    __int128_t ticks = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
-    return (int64_t) ticks;
+  static ns2cyc_data get_ns2cyc() noexcept
+  {
+    ns2cyc_data c;
+    if (ns2cyc.load(c) == 0) {
+      calibrate();
+      ns2cyc.load(c);
+    }
+    return c;
   }
 
-  static int64_t from_seconds(double seconds) noexcept {
-    // XXX use lrint intead of lround (honors fesetround) ?
-    return (int64_t) std::lround(seconds * ticks_per_second);
+  static double ticks_per_second() noexcept
+  {
+    return get().ticks_per_second;
   }
 
-  template <typename _ToRep, typename _ToPeriod>
-  static
-  typename std::enable_if<
-    std::chrono::treat_as_floating_point<_ToRep>::value,
-    std::chrono::duration<_ToRep, _ToPeriod>>::type
-  to_duration(double ticks)
+  static double seconds_per_tick() noexcept
   {
-    std::chrono::duration<double> d(to_seconds(ticks));
-    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+    return get().seconds_per_tick;
   }
 
-  template <typename _ToRep, typename _ToPeriod>
-  static
-  typename std::enable_if<
-    !std::chrono::treat_as_floating_point<_ToRep>::value,
-    std::chrono::duration<_ToRep, _ToPeriod>>::type
-  to_duration(int64_t ticks)
+  static tsc_frequency_source frequency_source() noexcept
   {
-    std::chrono::nanoseconds d(to_nanoseconds(ticks));
-    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+    return get().source;
   }
 
-  template <typename _FromRep, typename _FromPeriod>
-  static
-  typename std::enable_if<
-    std::chrono::treat_as_floating_point<_FromRep>::value,
-    double>::type
-  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  // estimated relative error of the current frequency, in parts per million
+  static double estimated_error() noexcept
   {
-    double s = std::chrono::duration_cast<std::chrono::duration<double>>(d).count();
-    return from_seconds(s);
+    return get().error_ppm;
   }
 
-  template <typename _FromRep, typename _FromPeriod>
-  static
-  typename std::enable_if<
-    !std::chrono::treat_as_floating_point<_FromRep>::value,
-    int64_t>::type
-  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  // incremented whenever a new frequency is published, but not when the epoch moves
+  static uint32_t generation() noexcept
   {
-    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
-    return from_nanoseconds(ns);
+    return frequency_generation.load(std::memory_order_acquire);
   }
+
+  // convert a TSC value far from the epoch with a 128-bit multiply, and move the epoch to it
+  static int64_t to_timestamp_far(int64_t ticks) noexcept;
+
+private:
+  // publish a new set of parameters, and the subsets used by the conversions
+  static void store(parameters const & p) noexcept;
+
+  static void refine(std::chrono::milliseconds interval);
+  static void publish_frequency(double ticks_per_second, double error_ppm);
+
+  // zero-initialised, so they can be used safely from other static initialisers
+  static seqlock<parameters>   params;
+  static seqlock<cyc2ns_data>  cyc2ns;
+  static seqlock<ns2cyc_data>  ns2cyc;
+  static std::atomic<uint32_t> frequency_generation;
+  static std::once_flag        calibrated_once;
 };
 
+// TSC ticks as clock period
+typedef runtime_tick<tsc_counter> tsc_tick;
+
 
 #endif // x86_tsc_tick_h
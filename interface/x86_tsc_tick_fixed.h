@@ -0,0 +1,133 @@
+#ifndef x86_tsc_tick_fixed_h
+#define x86_tsc_tick_fixed_h
+
+// C++ standard headers
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ratio>
+
+// for tsc_tick and the __int128_t shim for MSVC
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/duration_rounding.h"
+
+// check that the TSC is available, and that its frequency is within tolerance_ppm of hz
+bool check_tsc_fixed_frequency(uint64_t hz, double tolerance_ppm);
+
+// TSC ticks as clock period, for a TSC frequency known at compile time (e.g. for a known fleet of
+// machines), so that all the conversions use constants, and can be folded by the compiler:
+//
+//   typedef native::native_duration<int64_t, tsc_tick_fixed<2100000000>> duration;
+//
+// The conversions do not check the frequency: the program should call verify() before using this
+// period, e.g. at the start of main(), and fall back to tsc_tick if it returns false.
+template <uint64_t Hz, unsigned TolerancePpm = 100>
+struct tsc_tick_fixed {
+  static_assert(Hz > 0, "the TSC frequency must be positive");
+
+  static constexpr double  ticks_per_second = (double) Hz;
+  static constexpr double  seconds_per_tick = 1. / (double) Hz;
+  static constexpr int64_t nanoseconds_per_tick_shifted = (int64_t) ((1000000000ull << 32) / Hz);
+  // computed in two parts, so that (Hz << 32) does not overflow
+  static constexpr int64_t ticks_per_nanosecond_shifted = (int64_t) (((Hz / 1000000000ull) << 32) + ((Hz % 1000000000ull) << 32) / 1000000000ull);
+
+  // check the frequency against the one measured by tsc_tick, within TolerancePpm; the check (and
+  // the calibration of tsc_tick, if it has not been done yet) runs on the first call only
+  static bool verify()
+  {
+    static const bool verified = check_tsc_fixed_frequency(Hz, TolerancePpm);
+    return verified;
+  }
+
+  static int64_t to_nanoseconds(int64_t ticks) noexcept
+  {
+    // round the shifted value away from 0, like round() does
+    __int128_t shifted = (__int128_t) ticks * nanoseconds_per_tick_shifted;
+    __int128_t ns = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
+    return (int64_t) ns;
+  }
+
+  static double to_seconds(double ticks) noexcept
+  {
+    return ticks * seconds_per_tick;
+  }
+
+  static int64_t from_nanoseconds(int64_t ns) noexcept {
+    // round the shifted value away from 0, like round() does
+    __int128_t shifted = (__int128_t) ns * ticks_per_nanosecond_shifted;
+    __int128_t ticks = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
+    return (int64_t) ticks;
+  }
+
+  static int64_t from_seconds(double seconds) noexcept {
+    return (int64_t) std::lround(seconds * ticks_per_second);
+  }
+
+  template <typename _ToRep, typename _ToPeriod>
+  static
+  typename std::enable_if<
+    std::chrono::treat_as_floating_point<_ToRep>::value,
+    std::chrono::duration<_ToRep, _ToPeriod>>::type
+  to_duration(double ticks, duration_rounding = duration_rounding::toward_zero)
+  {
+    // like std::chrono::floor, ceil and round, the rounding only applies to integer durations
+    std::chrono::duration<double> d(to_seconds(ticks));
+    return std::chrono::duration_cast<std::chrono::duration<_ToRep, _ToPeriod>>( d );
+  }
+
+  template <typename _ToRep, typename _ToPeriod>
+  static
+  typename std::enable_if<
+    !std::chrono::treat_as_floating_point<_ToRep>::value,
+    std::chrono::duration<_ToRep, _ToPeriod>>::type
+  to_duration(int64_t ticks, duration_rounding mode = duration_rounding::toward_zero)
+  {
+    // units of the target period per tick, reduced at compile time, so that the conversion is exact
+    // and the division by a constant is replaced with a multiply
+    typedef std::ratio_divide<std::ratio<1, (intmax_t) Hz>, _ToPeriod> ratio;
+    int64_t units;
+    if (ticks <= INT64_MAX / ratio::num && ticks >= - (INT64_MAX / ratio::num))
+      units = rounded_divide<int64_t>(ticks * ratio::num, ratio::den, mode);
+    else
+      units = (int64_t) rounded_divide<__int128_t>((__int128_t) ticks * ratio::num, ratio::den, mode);
+    return std::chrono::duration<_ToRep, _ToPeriod>(static_cast<_ToRep>(units));
+  }
+
+  template <typename _FromRep, typename _FromPeriod>
+  static
+  typename std::enable_if<
+    std::chrono::treat_as_floating_point<_FromRep>::value,
+    double>::type
+  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  {
+    double s = std::chrono::duration_cast<std::chrono::duration<double>>(d).count();
+    return from_seconds(s);
+  }
+
+  template <typename _FromRep, typename _FromPeriod>
+  static
+  typename std::enable_if<
+    !std::chrono::treat_as_floating_point<_FromRep>::value,
+    int64_t>::type
+  from_duration(std::chrono::duration<_FromRep, _FromPeriod> d)
+  {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    return from_nanoseconds(ns);
+  }
+};
+
+// definitions of the static members, required before C++17
+template <uint64_t Hz, unsigned TolerancePpm>
+constexpr double  tsc_tick_fixed<Hz, TolerancePpm>::ticks_per_second;
+
+template <uint64_t Hz, unsigned TolerancePpm>
+constexpr double  tsc_tick_fixed<Hz, TolerancePpm>::seconds_per_tick;
+
+template <uint64_t Hz, unsigned TolerancePpm>
+constexpr int64_t tsc_tick_fixed<Hz, TolerancePpm>::nanoseconds_per_tick_shifted;
+
+template <uint64_t Hz, unsigned TolerancePpm>
+constexpr int64_t tsc_tick_fixed<Hz, TolerancePpm>::ticks_per_nanosecond_shifted;
+
+#endif // x86_tsc_tick_fixed_h
@@ -0,0 +1,243 @@
+#include "interface/batch_conversion.h"
+
+// for CHRONO_HAVE_X86_INTRINSICS
+#include "interface/x86_tsc.h"
+
+#if defined(CHRONO_HAVE_X86_INTRINSICS) && defined(__GNUC__)
+#define CHRONO_HAVE_SIMD_BATCH
+#include <immintrin.h>
+#endif
+
+// scalar version of batch_multiply_shifted(), on a single value: split the value and the factor in
+// 32-bit halves, and compute the bits 32 to 95 of the product modulo 2^64, so that no 128-bit type
+// is needed and the SIMD versions can use the same steps on 32x32-bit multiplies
+static inline int64_t multiply_shifted(int64_t value, uint64_t factor)
+{
+  uint64_t v  = (uint64_t) value;
+  uint64_t vh = v >> 32, vl = v & 0xffffffff;
+  uint64_t fh = factor >> 32, fl = factor & 0xffffffff;
+  uint64_t r  = (vh * fh << 32) + vh * fl + vl * fh + ((vl * fl + 0x80000000) >> 32);
+  // vh is the high half of a negative value plus 2^32
+  if (value < 0)
+    r -= fl << 32;
+  return (int64_t) r;
+}
+
+static void batch_multiply_shifted_scalar(const int64_t * in, int64_t * out, size_t size, uint64_t factor) noexcept
+{
+  for (size_t i = 0; i < size; ++i)
+    out[i] = multiply_shifted(in[i], factor);
+}
+
+static void batch_multiply_scalar(const double * in, double * out, size_t size, double factor) noexcept
+{
+  for (size_t i = 0; i < size; ++i)
+    out[i] = in[i] * factor;
+}
+
+static void batch_divide_scalar(const double * in, double * out, size_t size, double divisor) noexcept
+{
+  for (size_t i = 0; i < size; ++i)
+    out[i] = in[i] / divisor;
+}
+
+#ifdef CHRONO_HAVE_SIMD_BATCH
+
+__attribute__((target("avx2")))
+static void batch_multiply_shifted_avx2(const int64_t * in, int64_t * out, size_t size, uint64_t factor) noexcept
+{
+  const __m256i fl   = _mm256_set1_epi64x((int64_t) (factor & 0xffffffff));
+  const __m256i fh   = _mm256_set1_epi64x((int64_t) (factor >> 32));
+  const __m256i fls  = _mm256_set1_epi64x((int64_t) (factor << 32));
+  const __m256i half = _mm256_set1_epi64x(0x80000000);
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    // _mm256_mul_epu32 multiplies the low 32 bits of each 64-bit element
+    __m256i v    = _mm256_loadu_si256((const __m256i *) (in + i));
+    __m256i vh   = _mm256_srli_epi64(v, 32);
+    __m256i low  = _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epu32(v, fl), half), 32);
+    __m256i mid  = _mm256_add_epi64(_mm256_mul_epu32(vh, fl), _mm256_mul_epu32(v, fh));
+    __m256i high = _mm256_slli_epi64(_mm256_mul_epu32(vh, fh), 32);
+    __m256i sign = _mm256_and_si256(_mm256_cmpgt_epi64(zero, v), fls);
+    __m256i r    = _mm256_sub_epi64(_mm256_add_epi64(_mm256_add_epi64(low, mid), high), sign);
+    _mm256_storeu_si256((__m256i *) (out + i), r);
+  }
+  batch_multiply_shifted_scalar(in + i, out + i, size - i, factor);
+}
+
+__attribute__((target("avx2")))
+static void batch_multiply_avx2(const double * in, double * out, size_t size, double factor) noexcept
+{
+  const __m256d f = _mm256_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(in + i), f));
+  batch_multiply_scalar(in + i, out + i, size - i, factor);
+}
+
+__attribute__((target("avx2")))
+static void batch_divide_avx2(const double * in, double * out, size_t size, double divisor) noexcept
+{
+  const __m256d d = _mm256_set1_pd(divisor);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(in + i), d));
+  batch_divide_scalar(in + i, out + i, size - i, divisor);
+}
+
+__attribute__((target("avx512f")))
+static void batch_multiply_shifted_avx512(const int64_t * in, int64_t * out, size_t size, uint64_t factor) noexcept
+{
+  const __m512i fl   = _mm512_set1_epi64((int64_t) (factor & 0xffffffff));
+  const __m512i fh   = _mm512_set1_epi64((int64_t) (factor >> 32));
+  const __m512i fls  = _mm512_set1_epi64((int64_t) (factor << 32));
+  const __m512i half = _mm512_set1_epi64(0x80000000);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    // _mm512_mul_epu32 multiplies the low 32 bits of each 64-bit element
+    __m512i v    = _mm512_loadu_si512((const void *) (in + i));
+    __m512i vh   = _mm512_srli_epi64(v, 32);
+    __m512i low  = _mm512_srli_epi64(_mm512_add_epi64(_mm512_mul_epu32(v, fl), half), 32);
+    __m512i mid  = _mm512_add_epi64(_mm512_mul_epu32(vh, fl), _mm512_mul_epu32(v, fh));
+    __m512i high = _mm512_slli_epi64(_mm512_mul_epu32(vh, fh), 32);
+    __m512i sign = _mm512_and_si512(_mm512_srai_epi64(v, 63), fls);
+    __m512i r    = _mm512_sub_epi64(_mm512_add_epi64(_mm512_add_epi64(low, mid), high), sign);
+    _mm512_storeu_si512((void *) (out + i), r);
+  }
+  batch_multiply_shifted_scalar(in + i, out + i, size - i, factor);
+}
+
+__attribute__((target("avx512f")))
+static void batch_multiply_avx512(const double * in, double * out, size_t size, double factor) noexcept
+{
+  const __m512d f = _mm512_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(in + i), f));
+  batch_multiply_scalar(in + i, out + i, size - i, factor);
+}
+
+__attribute__((target("avx512f")))
+static void batch_divide_avx512(const double * in, double * out, size_t size, double divisor) noexcept
+{
+  const __m512d d = _mm512_set1_pd(divisor);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    _mm512_storeu_pd(out + i, _mm512_div_pd(_mm512_loadu_pd(in + i), d));
+  batch_divide_scalar(in + i, out + i, size - i, divisor);
+}
+
+#endif // CHRONO_HAVE_SIMD_BATCH
+
+
+namespace {
+
+  enum class batch_kernel { scalar, avx2, avx512 };
+
+  batch_kernel select_batch_kernel()
+  {
+#ifdef CHRONO_HAVE_SIMD_BATCH
+    // may run from an ifunc resolver, before the constructors of libgcc
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return batch_kernel::avx512;
+    if (__builtin_cpu_supports("avx2"))
+      return batch_kernel::avx2;
+#endif
+    return batch_kernel::scalar;
+  }
+
+} // namespace
+
+typedef void (*batch_multiply_shifted_t)(const int64_t *, int64_t *, size_t, uint64_t);
+typedef void (*batch_multiply_t)(const double *, double *, size_t, double);
+
+extern "C" {
+
+  static batch_multiply_shifted_t batch_multiply_shifted_resolver(void)
+  {
+    switch (select_batch_kernel()) {
+#ifdef CHRONO_HAVE_SIMD_BATCH
+      case batch_kernel::avx512:
+        return batch_multiply_shifted_avx512;
+      case batch_kernel::avx2:
+        return batch_multiply_shifted_avx2;
+#endif
+      default:
+        return batch_multiply_shifted_scalar;
+    }
+  }
+
+  static batch_multiply_t batch_multiply_resolver(void)
+  {
+    switch (select_batch_kernel()) {
+#ifdef CHRONO_HAVE_SIMD_BATCH
+      case batch_kernel::avx512:
+        return batch_multiply_avx512;
+      case batch_kernel::avx2:
+        return batch_multiply_avx2;
+#endif
+      default:
+        return batch_multiply_scalar;
+    }
+  }
+
+  static batch_multiply_t batch_divide_resolver(void)
+  {
+    switch (select_batch_kernel()) {
+#ifdef CHRONO_HAVE_SIMD_BATCH
+      case batch_kernel::avx512:
+        return batch_divide_avx512;
+      case batch_kernel::avx2:
+        return batch_divide_avx2;
+#endif
+      default:
+        return batch_divide_scalar;
+    }
+  }
+
+}
+
+const char * batch_conversion_kernel() noexcept
+{
+  switch (select_batch_kernel()) {
+    case batch_kernel::avx512:
+      return "AVX-512";
+    case batch_kernel::avx2:
+      return "AVX2";
+    default:
+      return "scalar";
+  }
+}
+
+// IFUNC support requires GCC >= 4.6.0 and GLIBC >= 2.11.1
+#if ( defined __GNUC__ && (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) ) \
+  && ( defined __GLIBC__ && (__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 11) )
+
+void batch_multiply_shifted(const int64_t * in, int64_t * out, size_t size, uint64_t factor) noexcept __attribute__((ifunc("batch_multiply_shifted_resolver")));
+void batch_multiply(const double * in, double * out, size_t size, double factor) noexcept __attribute__((ifunc("batch_multiply_resolver")));
+void batch_divide(const double * in, double * out, size_t size, double divisor) noexcept __attribute__((ifunc("batch_divide_resolver")));
+
+#else
+
+// resolve the implementation on first use, so that it is safe to call from static initialisers
+void batch_multiply_shifted(const int64_t * in, int64_t * out, size_t size, uint64_t factor) noexcept
+{
+  static const batch_multiply_shifted_t implementation = batch_multiply_shifted_resolver();
+  implementation(in, out, size, factor);
+}
+
+void batch_multiply(const double * in, double * out, size_t size, double factor) noexcept
+{
+  static const batch_multiply_t implementation = batch_multiply_resolver();
+  implementation(in, out, size, factor);
+}
+
+void batch_divide(const double * in, double * out, size_t size, double divisor) noexcept
+{
+  static const batch_multiply_t implementation = batch_divide_resolver();
+  implementation(in, out, size, divisor);
+}
+
+#endif // IFUNC support
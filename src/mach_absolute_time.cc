@@ -3,6 +3,7 @@
 // C++ standard headers
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 
 // Darwin system headers
 #include <mach/mach.h>
@@ -18,24 +19,78 @@ double calibrate_ticks_per_second() {
   return 1.e9 * timebase_info.denom / timebase_info.numer;
 }
 
+// convert the current value of mach_absolute_time exactly, with the timebase ratio
 static
-int64_t calibrate_nanoseconds_per_tick_shifted() {
+int64_t calibrate_epoch_nanoseconds(int64_t ticks) {
   mach_timebase_info_data_t timebase_info;
   mach_timebase_info(& timebase_info);
-  return (1ll << 32) * timebase_info.numer / timebase_info.denom;
+  return (int64_t) ((__int128_t) ticks * timebase_info.numer / timebase_info.denom);
 }
 
+// the limits leave room for the rounding
 static
-int64_t calibrate_ticks_per_nanosecond_shifted() {
+cyc2ns_data calibrate_cyc2ns() {
   mach_timebase_info_data_t timebase_info;
   mach_timebase_info(& timebase_info);
-  return (1ll << 32) * timebase_info.denom / timebase_info.numer;
+  cyc2ns_data c;
+  c.nanoseconds_per_tick_shifted = (1ull << 32) * timebase_info.numer / timebase_info.denom;
+  c.max_ticks         = (UINT64_MAX - 0xffffffff) / c.nanoseconds_per_tick_shifted;
+  c.epoch_ticks       = (int64_t) mach_absolute_time();
+  c.epoch_nanoseconds = calibrate_epoch_nanoseconds(c.epoch_ticks);
+  c.epoch_fraction    = 0;
+  return c;
 }
 
-const double  mach_absolute_time_tick::ticks_per_second = calibrate_ticks_per_second();
-const double  mach_absolute_time_tick::seconds_per_tick = 1. / mach_absolute_time_tick::ticks_per_second;
-const int64_t mach_absolute_time_tick::nanoseconds_per_tick_shifted = calibrate_nanoseconds_per_tick_shifted();
-const int64_t mach_absolute_time_tick::ticks_per_nanosecond_shifted = calibrate_ticks_per_nanosecond_shifted();
+static
+ns2cyc_data calibrate_ns2cyc() {
+  mach_timebase_info_data_t timebase_info;
+  mach_timebase_info(& timebase_info);
+  ns2cyc_data c;
+  c.ticks_per_nanosecond_shifted = (1ull << 32) * timebase_info.denom / timebase_info.numer;
+  c.max_nanoseconds = (UINT64_MAX - 0xffffffff) / c.ticks_per_nanosecond_shifted;
+  return c;
+}
+
+const double      mach_absolute_time_counter::ticks_per_second_value = calibrate_ticks_per_second();
+const double      mach_absolute_time_counter::seconds_per_tick_value = 1. / mach_absolute_time_counter::ticks_per_second_value;
+const ns2cyc_data mach_absolute_time_counter::ns2cyc = calibrate_ns2cyc();
+
+seqlock<cyc2ns_data> mach_absolute_time_counter::cyc2ns;
+std::atomic_flag     mach_absolute_time_counter::writer = ATOMIC_FLAG_INIT;
+
+void mach_absolute_time_counter::initialise() noexcept
+{
+  if (writer.test_and_set(std::memory_order_acquire))
+    return;
+
+  cyc2ns_data c;
+  if (cyc2ns.load(c) == 0)
+    cyc2ns.store(calibrate_cyc2ns());
+
+  writer.clear(std::memory_order_release);
+}
+
+// move the epoch forward to the given value, unless another thread is updating it; the
+// sub-nanosecond part is kept, so the timestamps are the same as with the previous epoch
+int64_t mach_absolute_time_counter::to_timestamp_far(int64_t ticks) noexcept
+{
+  cyc2ns_data c = get_cyc2ns();
+  __int128_t shifted = (__int128_t) (ticks - c.epoch_ticks) * (int64_t) c.nanoseconds_per_tick_shifted + (int64_t) c.epoch_fraction;
+  int64_t    ns      = c.epoch_nanoseconds + (int64_t) (shifted >> 32);
+  if (ticks > c.epoch_ticks && ! writer.test_and_set(std::memory_order_acquire)) {
+    // check that the epoch has not been moved in the meantime
+    cyc2ns_data current;
+    cyc2ns.load(current);
+    if (current.epoch_ticks == c.epoch_ticks) {
+      c.epoch_ticks       = ticks;
+      c.epoch_nanoseconds = ns;
+      c.epoch_fraction    = (uint64_t) (shifted & 0xffffffff);
+      cyc2ns.store(c);
+    }
+    writer.clear(std::memory_order_release);
+  }
+  return ns;
+}
 
 
 #endif // defined(__APPLE__) || defined(__MACH__)
@@ -0,0 +1,13 @@
+#include "interface/x86_tsc.h"
+#include "interface/native/perf_time_clock.h"
+
+#ifdef HAVE_PERF_TIME_TICK
+
+namespace native {
+
+  const bool clock_perf_time::is_available     = perf_time_counter::is_available();
+  const bool clock_perf_time::is_steady        = has_invariant_tsc();
+
+} // namespace native
+
+#endif // HAVE_PERF_TIME_TICK
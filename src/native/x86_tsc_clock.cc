@@ -17,7 +17,24 @@ namespace native {
   const bool clock_rdtscp::is_steady           = has_invariant_tsc();
 #endif
 
+#ifdef CHRONO_HAVE_RDTSCP
+  const bool clock_rdtscp_cpu::is_available    = has_rdtscp() and tsc_allowed();
+  const bool clock_rdtscp_cpu::is_steady       = has_invariant_tsc();
+#endif
+
+#ifdef CHRONO_HAVE_RDPID
+  const bool clock_rdpid_cpu::is_available     = has_tsc() and has_rdpid() and tsc_allowed();
+  const bool clock_rdpid_cpu::is_steady        = has_invariant_tsc();
+#endif
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+  const bool clock_rdtscp_compensated::is_available = has_rdtscp() and tsc_allowed();
+  const bool clock_rdtscp_compensated::is_steady    = has_invariant_tsc();
+#endif
+
   const bool clock_serialising_rdtsc::is_available    = has_tsc() and tsc_allowed();
   const bool clock_serialising_rdtsc::is_steady       = has_invariant_tsc();
+  const bool clock_tsc_realtime::is_available  = has_tsc() and tsc_allowed();
+  const bool clock_tsc_realtime::is_steady     = false;
 
 } // namespace native
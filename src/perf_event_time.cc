@@ -0,0 +1,87 @@
+#include "interface/perf_event_time.h"
+
+#ifdef HAVE_PERF_EVENT_TIME
+
+// C++ standard headers
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// Linux system headers
+#include <linux/perf_event.h>
+#include <linux/version.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+bool read_perf_event_time_parameters(perf_event_time_parameters & params) {
+  perf_event_attr attr;
+  memset(& attr, 0, sizeof(attr));
+  attr.type           = PERF_TYPE_SOFTWARE;
+  attr.size           = sizeof(attr);
+  attr.config         = PERF_COUNT_SW_DUMMY;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+
+  int fd = syscall(SYS_perf_event_open, & attr, 0, -1, -1, 0);
+  if (fd < 0)
+    return false;
+
+  long page_size = sysconf(_SC_PAGESIZE);
+  void * page = mmap(nullptr, page_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (page == MAP_FAILED)
+    return false;
+
+  // the kernel updates the page under a sequence lock
+  volatile perf_event_mmap_page * pc = (volatile perf_event_mmap_page *) page;
+  uint32_t seq;
+  bool     cap_user_time;
+  bool     cap_user_time_zero;
+  bool     cap_user_time_short;
+  do {
+    seq = pc->lock;
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+    cap_user_time       = pc->cap_user_time;
+    cap_user_time_zero  = pc->cap_user_time_zero;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 9, 0)
+    cap_user_time_short = pc->cap_user_time_short;
+#else
+    cap_user_time_short = false;
+#endif
+    params.time_zero    = pc->time_zero;
+    params.time_mult    = pc->time_mult;
+    params.time_shift   = pc->time_shift;
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+  } while (pc->lock != seq);
+
+  munmap(page, page_size);
+
+  // a short (wrapping) counter would need time_cycles and time_mask, and a shift of more than 32 bits
+  // would not fit the 32.32 fixed point ratios: tsc_tick and perf_time_tick support neither
+  return cap_user_time and cap_user_time_zero and not cap_user_time_short and params.time_mult != 0 and params.time_shift <= 32;
+}
+
+void perf_event_timestamp(perf_event_time_parameters const & params, int64_t ticks, int64_t & ns, uint64_t & fraction)
+{
+  __int128_t shifted = (__int128_t) ticks * params.time_mult;
+  ns       = (int64_t) params.time_zero + (int64_t) (shifted >> params.time_shift);
+  fraction = (uint64_t) (shifted & ((((__int128_t) 1) << params.time_shift) - 1)) << (32 - params.time_shift);
+}
+
+// the limits leave room for the rounding and for the fraction of the epoch
+perf_event_time_conversion perf_event_conversion(perf_event_time_parameters const & params, int64_t epoch_ticks)
+{
+  perf_event_time_conversion c;
+  c.ticks_per_second = std::ldexp(1.e9, params.time_shift) / params.time_mult;
+  c.seconds_per_tick = 1. / c.ticks_per_second;
+  c.cyc2ns.nanoseconds_per_tick_shifted = (uint64_t) params.time_mult << (32 - params.time_shift);
+  c.cyc2ns.max_ticks   = (UINT64_MAX - 0xffffffff) / c.cyc2ns.nanoseconds_per_tick_shifted;
+  c.cyc2ns.epoch_ticks = epoch_ticks;
+  perf_event_timestamp(params, epoch_ticks, c.cyc2ns.epoch_nanoseconds, c.cyc2ns.epoch_fraction);
+  c.ns2cyc.ticks_per_nanosecond_shifted = (uint64_t) ((((__int128_t) 1) << (32 + params.time_shift)) / params.time_mult);
+  c.ns2cyc.max_nanoseconds = (UINT64_MAX - 0xffffffff) / c.ns2cyc.ticks_per_nanosecond_shifted;
+  return c;
+}
+
+#endif // HAVE_PERF_EVENT_TIME
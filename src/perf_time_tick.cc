@@ -0,0 +1,50 @@
+#include "interface/perf_time_tick.h"
+
+#ifdef HAVE_PERF_TIME_TICK
+
+seqlock<cyc2ns_data> perf_time_counter::cyc2ns;
+std::atomic_flag     perf_time_counter::epoch_writer = ATOMIC_FLAG_INIT;
+
+// read the parameters of the kernel, if it publishes the conversion of the TSC, and set the first
+// epoch at the start of the program
+static perf_time_counter::constant_data read_constants(seqlock<cyc2ns_data> & cyc2ns)
+{
+  perf_time_counter::constant_data c = {};
+  perf_event_time_parameters & p = c.parameters;
+  if (!has_tsc() || !tsc_allowed() || !read_perf_event_time_parameters(p)) {
+    p = perf_event_time_parameters { 0, 0, 0 };
+    return c;
+  }
+
+  perf_event_time_conversion conversion = perf_event_conversion(p, rdtsc());
+  c.ticks_per_second = conversion.ticks_per_second;
+  c.seconds_per_tick = conversion.seconds_per_tick;
+  c.ns2cyc = conversion.ns2cyc;
+  cyc2ns.store(conversion.cyc2ns);
+  return c;
+}
+
+// initialised before the objects without an explicit priority, so that the clocks defined in other
+// translation units can already use the conversions
+#if defined __GNUC__ && defined __ELF__
+__attribute__((init_priority(101)))
+#endif
+const perf_time_counter::constant_data perf_time_counter::constants = read_constants(perf_time_counter::cyc2ns);
+
+// move the epoch forward to the given TSC value, unless another thread is already moving it
+int64_t perf_time_counter::to_timestamp_far(int64_t ticks) noexcept
+{
+  int64_t  ns;
+  uint64_t fraction;
+  perf_event_timestamp(constants.parameters, ticks, ns, fraction);
+  if (is_available() && !epoch_writer.test_and_set(std::memory_order_acquire)) {
+    cyc2ns_data c;
+    cyc2ns.load(c);
+    if (ticks > c.epoch_ticks)
+      cyc2ns.store(perf_event_conversion(constants.parameters, ticks).cyc2ns);
+    epoch_writer.clear(std::memory_order_release);
+  }
+  return ns;
+}
+
+#endif // HAVE_PERF_TIME_TICK
@@ -0,0 +1,15 @@
+#ifndef _WIN32
+
+// POSIX standard headers
+#include <unistd.h>
+
+#include "interface/posix_times_scale.h"
+
+// initialise the scale before the static initialisers of other translation units, so that they
+// can already use the times() clocks
+#if defined __GNUC__ && defined __ELF__
+__attribute__((init_priority(101)))
+#endif
+const tick_scale times_scale = tick_scale::from_ticks_per_second(sysconf(_SC_CLK_TCK));
+
+#endif // !defined(_WIN32)
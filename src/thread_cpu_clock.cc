@@ -0,0 +1,66 @@
+#include "interface/thread_cpu_clock.h"
+
+#ifdef HAVE_THREAD_CPU_CLOCK
+
+// C++ standard headers
+#include <limits>
+
+static int64_t read_monotonic()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (int64_t) t.tv_sec * 1000000000ll + t.tv_nsec;
+}
+
+size_t thread_cpu_sampler::add(pthread_t thread)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  clocks_.push_back(thread_cpu_clock(thread));
+  removed_.push_back(false);
+  return clocks_.size() - 1;
+}
+
+void thread_cpu_sampler::remove(size_t index)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index < removed_.size())
+    removed_[index] = true;
+}
+
+size_t thread_cpu_sampler::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return clocks_.size();
+}
+
+void thread_cpu_sampler::sample(snapshot & result) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  result.cpu_time.resize(clocks_.size());
+
+  result.begin = read_monotonic();
+  for (size_t i = 0; i < clocks_.size(); ++i) {
+    timespec t;
+    if (! removed_[i] && clocks_[i].is_available() && clock_gettime(clocks_[i].id(), &t) == 0)
+      result.cpu_time[i] = (int64_t) t.tv_sec * 1000000000ll + t.tv_nsec;
+    else
+      result.cpu_time[i] = -1;
+  }
+  result.end = read_monotonic();
+}
+
+void thread_cpu_sampler::utilization(snapshot const & first, snapshot const & second, std::vector<double> & result)
+{
+  // twice the wall-clock time between the midpoints of the two passes
+  double interval = (double) ((second.begin + second.end) - (first.begin + first.end));
+
+  result.resize(second.cpu_time.size());
+  for (size_t i = 0; i < result.size(); ++i) {
+    if (i >= first.cpu_time.size() || first.cpu_time[i] < 0 || second.cpu_time[i] < 0 || interval <= 0.)
+      result[i] = std::numeric_limits<double>::quiet_NaN();
+    else
+      result[i] = 2. * (double) (second.cpu_time[i] - first.cpu_time[i]) / interval;
+  }
+}
+
+#endif // HAVE_THREAD_CPU_CLOCK
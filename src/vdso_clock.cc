@@ -0,0 +1,92 @@
+#include "interface/vdso_clock.h"
+
+#ifdef HAVE_VDSO_CLOCK
+
+// C standard headers
+#include <cstdio>
+#include <cstring>
+
+// find the address of the vDSO data page in /proc/self/maps
+static const volatile uint8_t * find_vvar_page()
+{
+  FILE * maps = fopen("/proc/self/maps", "r");
+  if (maps == nullptr)
+    return nullptr;
+
+  const volatile uint8_t * page = nullptr;
+  char line[512];
+  while (fgets(line, sizeof(line), maps)) {
+    // match "[vvar]" exactly, not e.g. "[vvar_vclock]"
+    if (strstr(line, "[vvar]\n")) {
+      unsigned long start;
+      if (sscanf(line, "%lx-", & start) == 1)
+        page = (const volatile uint8_t *) start;
+      break;
+    }
+  }
+  fclose(maps);
+  return page;
+}
+
+static int64_t clock_gettime_monotonic_ns()
+{
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (int64_t) t.tv_sec * 1000000000ll + t.tv_nsec;
+}
+
+// the values read with a candidate layout must be kernel-identical, so they must fall between two
+// calls to clock_gettime(); a wrong layout, or a time namespace, gives values far from them
+static bool check_layout(vdso_clock_layout const & layout)
+{
+  const volatile uint8_t * vc = layout.data;
+
+  // the sequence count may be odd only while the kernel updates the data; the reader would spin
+  // forever on an odd value at a wrong offset
+  int attempts = 0;
+  while ((* (const volatile uint32_t *) vc & 1) && ++attempts < 1000)
+    _mm_pause();
+  if ((* (const volatile uint32_t *) vc & 1) || * (const volatile int32_t *) (vc + 4) != 1)
+    return false;
+
+  uint32_t shift = * (const volatile uint32_t *) (vc + 28 + layout.extra);
+  uint64_t mask  = * (const volatile uint64_t *) (vc + 16 + layout.extra);
+  if (mask != UINT64_MAX || shift >= 64)
+    return false;
+
+  for (int i = 0; i < 8; ++i) {
+    int64_t before = clock_gettime_monotonic_ns();
+    int64_t ns;
+    if (!read_vdso_monotonic(layout, ns))
+      return false;
+    int64_t after  = clock_gettime_monotonic_ns();
+    if (ns < before || ns > after)
+      return false;
+  }
+  return true;
+}
+
+// look for the clock data at the offsets used by the known kernel versions: at the start of the
+// page since Linux 6.13, at offset 128 in the x86 vvar page before; max_cycles is present since
+// Linux 6.8
+static vdso_clock_layout locate_vdso_clock()
+{
+  vdso_clock_layout none = { nullptr, 0 };
+  const volatile uint8_t * page = find_vvar_page();
+  if (page == nullptr || !has_tsc() || !tsc_allowed())
+    return none;
+
+  static const uint32_t offsets[] = { 0, 128 };
+  static const uint32_t extras[]  = { 8, 0 };
+  for (uint32_t offset: offsets)
+    for (uint32_t extra: extras) {
+      vdso_clock_layout layout = { page + offset, extra };
+      if (check_layout(layout))
+        return layout;
+    }
+  return none;
+}
+
+const vdso_clock_layout clock_vdso_monotonic::layout = locate_vdso_clock();
+
+#endif // HAVE_VDSO_CLOCK
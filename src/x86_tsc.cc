@@ -2,13 +2,20 @@
 #include <chrono>
 #include <thread>
 #include <cmath>
+#include <fstream>
+#include <cstring>
+#include <limits>
 
 // for usleep
 #ifndef _WIN32
 #include <unistd.h>
 #endif
 
+// for clock_gettime
+#include <time.h>
+
 #include "interface/x86_tsc.h"
+#include "interface/linear_regression.h"
 
 #ifdef CHRONO_HAVE_TSC
 
@@ -38,15 +45,36 @@
 #define bit_RDTSCP          (1 << 27)
 #endif
 
+// CPUID, EAX = 0x07, ECX = 0x00, ECX values
+#ifndef bit_RDPID
+#define bit_RDPID           (1 << 22)
+#endif
+
 // CPUID, EAX = 0x80000007, EDX values
 #ifndef bit_InvariantTSC
 #define bit_InvariantTSC    (1 << 8)
 #endif
 
+// CPUID, EAX = 0x01, ECX values
+#ifndef bit_Hypervisor
+#define bit_Hypervisor      (1u << 31)
+#endif
+
 #ifdef CHRONO_HAVE_X86_INTRINSICS
 #ifdef _MSC_VER
+// like the GCC versions, check that the leaf is within the range reported by the processor: an
+// unsupported leaf returns the data of the highest basic leaf instead, not zeroes
+static inline bool __cpuid_leaf_supported(uint32_t leaf)
+{
+    int out[4];
+    __cpuid(out, leaf & 0x80000000);
+    return (uint32_t) out[0] >= leaf;
+}
+
 static inline int __get_cpuid(uint32_t leaf, uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx)
 {
+    if (!__cpuid_leaf_supported(leaf))
+        return 0;
     int out[4];
     __cpuid(out, leaf);
     *eax = out[0];
@@ -55,6 +83,19 @@ static inline int __get_cpuid(uint32_t leaf, uint32_t *eax, uint32_t *ebx, uint3
     *edx = out[3];
     return 1;
 }
+
+static inline int __get_cpuid_count(uint32_t leaf, uint32_t subleaf, uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx)
+{
+    if (!__cpuid_leaf_supported(leaf))
+        return 0;
+    int out[4];
+    __cpuidex(out, leaf, subleaf);
+    *eax = out[0];
+    *ebx = out[1];
+    *ecx = out[2];
+    *edx = out[3];
+    return 1;
+}
 #endif
 
 // check if the processor has a TSC (Time Stamp Counter) and supports the RDTSC instruction
@@ -75,6 +116,15 @@ bool has_rdtscp() {
     return false;
 }
 
+// check if the processor supports the RDPID instruction
+bool has_rdpid() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_count(0x07, 0x00, & eax, & ebx, & ecx, & edx))
+    return (ecx & bit_RDPID) != 0;
+  else
+    return false;
+}
+
 // check if the processor supports the Invariant TSC feature (constant frequency TSC)
 bool has_invariant_tsc() {
   unsigned int eax, ebx, ecx, edx;
@@ -83,14 +133,84 @@ bool has_invariant_tsc() {
   else
     return false;
 }
+
+// read the TSC frequency from CPUID leaf 0x15 (TSC / core crystal clock ratio and crystal frequency)
+static double cpuid_crystal_tsc_hz() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x15, & eax, & ebx, & ecx, & edx))
+    return 0;
+  // eax is the denominator and ebx the numerator of the TSC / crystal ratio;
+  // ecx is the crystal frequency in Hz, or 0 if it is not enumerated
+  if (eax == 0 || ebx == 0 || ecx == 0)
+    return 0;
+  return (double) ecx * ebx / eax;
+}
+
+// read the processor base frequency from CPUID leaf 0x16; this is the nominal frequency of the
+// processor, reported in MHz, and the TSC frequency may differ from it by more than the rounding
+static double cpuid_base_tsc_hz() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x16, & eax, & ebx, & ecx, & edx))
+    return 0;
+  return (eax & 0xffff) * 1.e6;
+}
+
+// read the TSC frequency exposed by a hypervisor in CPUID leaf 0x40000010
+//
+// The leaf is only defined by the VMware interface; other hypervisors may use it for something
+// else, so the vendor signature in leaf 0x40000000 is checked first. KVM only reports it when QEMU
+// is configured with vmware-cpuid-freq, that requires an invariant TSC.
+static double hypervisor_tsc_hz() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(0x01, & eax, & ebx, & ecx, & edx) || (ecx & bit_Hypervisor) == 0)
+    return 0;
+  // __get_cpuid() only checks the basic and extended ranges, so query the hypervisor range directly
+#ifdef _MSC_VER
+  int out[4];
+  __cpuid(out, 0x40000000);
+  eax = out[0];
+  ebx = out[1];
+  ecx = out[2];
+  edx = out[3];
+#else
+  __cpuid(0x40000000, eax, ebx, ecx, edx);
+#endif
+  if (eax < 0x40000010)
+    return 0;
+
+  char signature[13];
+  std::memcpy(signature + 0, & ebx, 4);
+  std::memcpy(signature + 4, & ecx, 4);
+  std::memcpy(signature + 8, & edx, 4);
+  signature[12] = '\0';
+  bool vmware = std::strcmp(signature, "VMwareVMware") == 0;
+  bool kvm    = std::strcmp(signature, "KVMKVMKVM") == 0 && has_invariant_tsc();
+  if (!vmware && !kvm)
+    return 0;
+
+#ifdef _MSC_VER
+  __cpuid(out, 0x40000010);
+  eax = out[0];
+#else
+  __cpuid(0x40000010, eax, ebx, ecx, edx);
+#endif
+  // eax is the TSC frequency in kHz
+  return eax * 1.e3;
+}
 #else
+static double cpuid_crystal_tsc_hz() { return 0; }
+static double cpuid_base_tsc_hz() { return 0; }
+static double hypervisor_tsc_hz() { return 0; }
+
 #ifdef CHRONO_HAVE_TSC
 bool has_tsc() { return true; }
 bool has_rdtscp() { return false; }
+bool has_rdpid() { return false; }
 bool has_invariant_tsc() { return true; }
 #else
 bool has_tsc() { return false; }
 bool has_rdtscp() { return false; }
+bool has_rdpid() { return false; }
 bool has_invariant_tsc() { return false; }
 #endif
 #endif
@@ -117,6 +237,69 @@ bool tsc_allowed() {
 
 #undef _HAS_PR_TSC_ENABLE
 
+// read the TSC frequency measured by the kernel, if it is exposed to user space
+static double kernel_tsc_hz() {
+#ifdef __linux__
+  // not part of the upstream kernel, but exported by some distributions and out-of-tree modules
+  std::ifstream tsc_freq_khz("/sys/devices/system/cpu/cpu0/tsc_freq_khz");
+  unsigned long khz = 0;
+  if (tsc_freq_khz >> khz)
+    return khz * 1.e3;
+#endif // __linux__
+  return 0;
+}
+
+const char * tsc_frequency_source_name(tsc_frequency_source source) {
+  switch (source) {
+    case tsc_frequency_source::perf_event:
+      return "perf_event";
+    case tsc_frequency_source::cpuid_crystal:
+      return "CPUID 0x15";
+    case tsc_frequency_source::kernel:
+      return "kernel";
+    case tsc_frequency_source::hypervisor:
+      return "hypervisor";
+    case tsc_frequency_source::cpuid_base:
+      return "CPUID 0x16";
+    case tsc_frequency_source::calibration:
+      return "calibration";
+    case tsc_frequency_source::none:
+    default:
+      return "none";
+  }
+}
+
+// read the TSC frequency from the most accurate source available, falling back to calibrate_tsc()
+tsc_calibration discover_tsc_frequency(double target_ppm, std::chrono::milliseconds max_time) {
+  if (!has_tsc() || !tsc_allowed())
+    return tsc_calibration{ 0., std::numeric_limits<double>::quiet_NaN(), tsc_frequency_source::none };
+
+  struct {
+    tsc_frequency_source source;
+    double             (*read)();
+    double               resolution;          // granularity of the reported value, in Hz; NaN if it does not bound the error
+  } const sources[] = {
+    // the TSC is derived from the crystal clock by an exact ratio, but the crystal frequency is a
+    // nominal one (e.g. 24 or 25 MHz), and the actual crystal is often off by tens of ppm
+    { tsc_frequency_source::cpuid_crystal, cpuid_crystal_tsc_hz, std::numeric_limits<double>::quiet_NaN() },
+    { tsc_frequency_source::kernel,        kernel_tsc_hz,        1.e3  },
+    { tsc_frequency_source::hypervisor,    hypervisor_tsc_hz,    1.e3  },
+    // a nominal frequency: the rounding to 1 MHz does not bound its error
+    { tsc_frequency_source::cpuid_base,    cpuid_base_tsc_hz,    std::numeric_limits<double>::quiet_NaN() },
+  };
+
+  for (auto const & s: sources) {
+    double hz = s.read();
+    if (hz > 0) {
+      // the rounding of the reported value is the only error that can be estimated
+      double error_ppm = s.resolution / 2. / hz * 1.e6;
+      return tsc_calibration{ hz, error_ppm, s.source };
+    }
+  }
+
+  return calibrate_tsc(target_ppm, max_time);
+}
+
 static inline void spin_for(uint32_t usec)
 {
   uint32_t elapsed;
@@ -127,39 +310,77 @@ static inline void spin_for(uint32_t usec)
   } while (elapsed < usec);
 }
 
-// calibrate TSC with respect to std::chrono::high_resolution_clock
-double calibrate_tsc_hz() {
-  if (!has_tsc() || !tsc_allowed())
-    return 0;
+// read the reference clock used for the calibration, in nanoseconds;
+// use CLOCK_MONOTONIC_RAW where available, so that NTP adjustments do not leak into the TSC frequency
+static int64_t reference_nanoseconds()
+{
+#ifdef CLOCK_MONOTONIC_RAW
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC_RAW, & t);
+  return (int64_t) t.tv_sec * 1000000000ll + (int64_t) t.tv_nsec;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
 
-  constexpr unsigned int sample_size = 1000;        // 1000 samples
-  constexpr unsigned int sleep_time  = 1000;        //    1 ms
-  unsigned long long ticks[sample_size];
-  double             times[sample_size];
+// read the reference clock between two reads of the TSC; a preemption or an SMI between the reads
+// widens the bracket, so keep the narrowest of a few attempts and use the midpoint of its TSC reads
+tsc_sample sample_tsc(unsigned int attempts) {
+  return sample_tsc(reference_nanoseconds, attempts);
+}
 
-  auto reference = std::chrono::high_resolution_clock::now();
-  for (unsigned int i = 0; i < sample_size; ++i) {
-    spin_for(sleep_time);
-    ticks[i] = rdtsc();
-    times[i] = std::chrono::duration_cast<std::chrono::duration<double>>( std::chrono::high_resolution_clock::now() - reference ).count();
+tsc_sample sample_tsc(int64_t (*reference)(), unsigned int attempts) {
+  tsc_sample best = { 0, 0, std::numeric_limits<uint64_t>::max() };
+  for (unsigned int i = 0; i < attempts; ++i) {
+    uint64_t before = rdtsc();
+    int64_t  ns     = reference();
+    uint64_t after  = rdtsc();
+    if (after - before < best.bracket) {
+      best.nanoseconds = ns;
+      best.ticks       = before + (after - before) / 2;
+      best.bracket     = after - before;
+    }
   }
+  return best;
+}
 
-  double mean_x = 0, mean_y = 0;
-  for (unsigned int i = 0; i < sample_size; ++i) {
-    mean_x += (double) times[i];
-    mean_y += (double) ticks[i];
-  }
-  mean_x /= (double) sample_size;
-  mean_y /= (double) sample_size;
+// calibrate TSC with respect to CLOCK_MONOTONIC_RAW (or std::chrono::steady_clock)
+//
+// Take one bracketed sample every millisecond, and extend a linear fit of the TSC against the
+// reference clock until the standard error of its slope falls below target_ppm, or max_time has
+// elapsed.
+tsc_calibration calibrate_tsc(double target_ppm, std::chrono::milliseconds max_time) {
+  if (!has_tsc() || !tsc_allowed())
+    return tsc_calibration{ 0., std::numeric_limits<double>::quiet_NaN(), tsc_frequency_source::none };
+
+  constexpr unsigned int min_samples = 10;          //   10 samples
+  constexpr unsigned int sleep_time  = 1000;        //    1 ms
+  constexpr unsigned int attempts    = 8;           //    8 brackets per sample
+
+  linear_regression fit;
+  double error_ppm = std::numeric_limits<double>::quiet_NaN();
 
-  double sigma_xy = 0, sigma_xx = 0;
-  for (unsigned int i = 0; i < sample_size; ++i) {
-    sigma_xx += (double) (times[i] - mean_x) * (double) (times[i] - mean_x);
-    sigma_xy += (double) (times[i] - mean_x) * (double) (ticks[i] - mean_y);
+  int64_t  max_ns    = std::chrono::duration_cast<std::chrono::nanoseconds>(max_time).count();
+  tsc_sample first   = sample_tsc(attempts);
+  while (true) {
+    spin_for(sleep_time);
+    tsc_sample sample = sample_tsc(attempts);
+    int64_t elapsed = sample.nanoseconds - first.nanoseconds;
+    fit.add((double) elapsed * 1.e-9, (double) (sample.ticks - first.ticks));
+
+    if (fit.n >= min_samples) {
+      error_ppm = fit.slope_error() / fit.slope() * 1.e6;
+      if (error_ppm <= target_ppm || elapsed >= max_ns)
+        break;
+    }
   }
 
   // ticks per second
-  return sigma_xy / sigma_xx;
+  return tsc_calibration{ fit.slope(), error_ppm, tsc_frequency_source::calibration };
+}
+
+double calibrate_tsc_hz() {
+  return calibrate_tsc().hz;
 }
 
 
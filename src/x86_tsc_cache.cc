@@ -0,0 +1,180 @@
+#include "interface/x86_tsc_cache.h"
+
+#ifdef CHRONO_HAVE_TSC_CACHE
+
+// C++ standard headers
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+// POSIX and Linux system headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// for cpuid
+#ifdef CHRONO_HAVE_X86_INTRINSICS
+#include <cpuid.h>
+#endif
+
+namespace {
+
+  constexpr uint32_t tsc_cache_magic   = 0x63737463;   // "ctsc"
+  constexpr uint32_t tsc_cache_version = 4;
+
+  // everything that may change the TSC frequency or its conversion
+  struct tsc_cache_key {
+    char     boot_id[40];
+    char     clocksource[32];
+    char     cpu_vendor[12];
+    uint32_t cpu_signature;                   // CPUID leaf 0x01, EAX: stepping, model and family
+  };
+
+  struct tsc_cache_entry {
+    uint32_t             magic;
+    uint32_t             version;
+    tsc_cache_key        key;
+    tsc_tick::parameters parameters;
+    uint64_t             checksum;
+  };
+
+  std::mutex  cache_path_mutex;
+  std::string cache_path;
+
+  // read the first word of a file into a fixed size, zero padded buffer
+  template <size_t N>
+  bool read_word(const char * filename, char (& buffer)[N]) {
+    std::ifstream file(filename);
+    std::string   word;
+    if (not (file >> word) or word.size() >= N)
+      return false;
+    memcpy(buffer, word.data(), word.size());
+    return true;
+  }
+
+  bool read_key(tsc_cache_key & key) {
+    memset(& key, 0, sizeof(key));
+    if (not read_word("/proc/sys/kernel/random/boot_id", key.boot_id))
+      return false;
+    if (not read_word("/sys/devices/system/clocksource/clocksource0/current_clocksource", key.clocksource))
+      return false;
+#ifdef CHRONO_HAVE_X86_INTRINSICS
+    unsigned int eax, ebx, ecx, edx;
+    if (not __get_cpuid(0x00, & eax, & ebx, & ecx, & edx))
+      return false;
+    memcpy(key.cpu_vendor + 0, & ebx, 4);
+    memcpy(key.cpu_vendor + 4, & edx, 4);
+    memcpy(key.cpu_vendor + 8, & ecx, 4);
+    if (not __get_cpuid(0x01, & eax, & ebx, & ecx, & edx))
+      return false;
+    key.cpu_signature = eax;
+#endif
+    return true;
+  }
+
+  // FNV-1a hash of the entry, excluding the checksum itself
+  uint64_t checksum(tsc_cache_entry const & entry) {
+    const unsigned char * data = (const unsigned char *) & entry;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < offsetof(tsc_cache_entry, checksum); ++i) {
+      hash ^= data[i];
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+
+} // namespace
+
+void enable_tsc_cache(std::string const & path) {
+  std::lock_guard<std::mutex> lock(cache_path_mutex);
+  if (not path.empty()) {
+    cache_path = path;
+  } else {
+    // there is no private default location without XDG_RUNTIME_DIR: leave the cache disabled
+    // rather than use a path that other users can create first
+    const char * runtime_dir = getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir and *runtime_dir)
+      cache_path = std::string(runtime_dir) + "/chrono-tsc.cache";
+  }
+}
+
+std::string tsc_cache_path() {
+  static std::once_flag environment_once;
+  std::call_once(environment_once, [] {
+    const char * value = getenv("CHRONO_TSC_CACHE");
+    if (value and *value)
+      enable_tsc_cache(strcmp(value, "1") == 0 ? std::string() : std::string(value));
+  });
+
+  std::lock_guard<std::mutex> lock(cache_path_mutex);
+  return cache_path;
+}
+
+bool read_tsc_cache(std::string const & path, tsc_tick::parameters & p) {
+  tsc_cache_key key;
+  if (not read_key(key))
+    return false;
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+  if (fd < 0)
+    return false;
+
+  // only trust a regular file owned by the effective user, that nobody else can write to
+  struct stat info;
+  if (fstat(fd, & info) != 0 or not S_ISREG(info.st_mode) or info.st_uid != geteuid() or
+      (info.st_mode & (S_IWGRP | S_IWOTH)) != 0 or info.st_size != sizeof(tsc_cache_entry)) {
+    close(fd);
+    return false;
+  }
+
+  void * data = mmap(nullptr, sizeof(tsc_cache_entry), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  tsc_cache_entry const & entry = * (tsc_cache_entry const *) data;
+  bool valid = entry.magic    == tsc_cache_magic   and
+               entry.version  == tsc_cache_version and
+               entry.checksum == checksum(entry)   and
+               memcmp(& entry.key, & key, sizeof(key)) == 0 and
+               entry.parameters.ticks_per_second > 0 and
+               entry.parameters.source != tsc_frequency_source::perf_event;
+  if (valid)
+    p = entry.parameters;
+
+  munmap(data, sizeof(tsc_cache_entry));
+  return valid;
+}
+
+bool write_tsc_cache(std::string const & path, tsc_tick::parameters const & p) {
+  // the perf_event parameters are cheap to read again, and change across a suspend and resume
+  if (p.source == tsc_frequency_source::perf_event)
+    return false;
+
+  tsc_cache_entry entry;
+  memset(& entry, 0, sizeof(entry));
+  if (not read_key(entry.key))
+    return false;
+  entry.magic      = tsc_cache_magic;
+  entry.version    = tsc_cache_version;
+  entry.parameters = p;
+  entry.checksum   = checksum(entry);
+
+  // write to a temporary file and rename it, so that readers never see a partial entry
+  std::string temp = path + ".XXXXXX";
+  int fd = mkstemp(& temp[0]);
+  if (fd < 0)
+    return false;
+
+  bool done = (write(fd, & entry, sizeof(entry)) == (ssize_t) sizeof(entry));
+  done = (close(fd) == 0) and done;
+  done = done and (rename(temp.c_str(), path.c_str()) == 0);
+  if (not done)
+    unlink(temp.c_str());
+  return done;
+}
+
+#endif // CHRONO_HAVE_TSC_CACHE
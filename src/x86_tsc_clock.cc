@@ -15,5 +15,31 @@ const bool clock_rdtscp::is_available               = has_rdtscp() && tsc_allowe
 const bool clock_rdtscp::is_steady                  = has_invariant_tsc();
 #endif
 
+#ifdef CHRONO_HAVE_RDTSCP
+const bool clock_rdtscp_cpu::is_available           = has_rdtscp() && tsc_allowed();
+const bool clock_rdtscp_cpu::is_steady              = has_invariant_tsc();
+#endif
+
+#ifdef CHRONO_HAVE_RDPID
+const bool clock_rdpid_cpu::is_available            = has_tsc() && has_rdpid() && tsc_allowed();
+const bool clock_rdpid_cpu::is_steady               = has_invariant_tsc();
+#endif
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+const bool clock_rdtscp_compensated::is_available   = has_rdtscp() && tsc_allowed();
+const bool clock_rdtscp_compensated::is_steady      = has_invariant_tsc();
+#endif
+
 const bool clock_serialising_rdtsc::is_available    = has_tsc() && tsc_allowed();
 const bool clock_serialising_rdtsc::is_steady       = has_invariant_tsc();
+
+const bool clock_tsc_realtime::is_available         = has_tsc() && tsc_allowed();
+const bool clock_tsc_realtime::is_steady            = false;
+
+const bool clock_tsc_monotonic::is_available        = has_tsc() && tsc_allowed();
+const bool clock_tsc_monotonic::is_steady           = false;   // may go backwards around a resync
+
+#ifdef HAVE_TSC_COARSE
+const bool clock_tsc_coarse::is_available           = has_tsc() && tsc_allowed();
+const bool clock_tsc_coarse::is_steady              = false;   // only monotonic within each thread
+#endif
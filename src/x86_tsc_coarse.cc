@@ -0,0 +1,85 @@
+// C++ standard headers
+#include <algorithm>
+
+#include "interface/x86_tsc_coarse.h"
+#include "interface/x86_tsc_tick.h"
+
+#ifdef HAVE_TSC_COARSE
+
+static int64_t read_clock(clockid_t clock)
+{
+  timespec t;
+  clock_gettime(clock, &t);
+  return (int64_t) t.tv_sec * 1000000000ll + t.tv_nsec;
+}
+
+// resolution of CLOCK_MONOTONIC_COARSE, i.e. the interval between its updates
+static int64_t coarse_resolution()
+{
+  static const int64_t resolution = [] {
+    timespec t;
+    if (clock_getres(CLOCK_MONOTONIC_COARSE, &t) != 0)
+      return (int64_t) 1000000;
+    return (int64_t) (t.tv_sec * 1000000000ll + t.tv_nsec);
+  }();
+  return resolution;
+}
+
+// the values returned to a thread never go backwards
+static int64_t returned(tsc_coarse::anchor & a, int64_t ns)
+{
+  if (ns < a.last)
+    ns = a.last;
+  a.last = ns;
+  return ns;
+}
+
+int64_t tsc_coarse::resync(anchor & a, int64_t ticks) noexcept
+{
+  int64_t coarse     = read_clock(CLOCK_MONOTONIC_COARSE);
+  int64_t resolution = coarse_resolution();
+  int64_t limit      = coarse + resolution - 1;
+
+  int64_t ns;
+  if (a.window == 0) {
+    // first anchor of the thread, at an unknown distance from the last update of the coarse clock
+    ns       = coarse;
+    a.window = resolution / 2;
+  } else {
+    __int128_t shifted = (__int128_t) (ticks - a.ticks) * a.nanoseconds_per_tick_shifted;
+    ns = a.nanoseconds + (int64_t) (shifted >> 32);
+
+    // the coarse clock has not been updated yet: keep the anchor, and stall at the limit
+    if (coarse == a.coarse) {
+      a.polling = true;
+      return returned(a, ns < limit ? ns : limit);
+    }
+
+    // the coarse clock has been updated: if the update was seen by polling within the window, this
+    // call is just after it, and the window can be narrowed; otherwise it happened before the
+    // window, and the interpolation may lag behind
+    if (a.polling)
+      a.window = std::max(a.window / 2, resolution / 64);
+    else
+      a.window = std::min(a.window * 2, resolution / 2);
+    a.polling = false;
+
+    // keep the interpolation, within the bounds of the new coarse value
+    if (ns < coarse)
+      ns = coarse;
+    if (ns > limit)
+      ns = limit;
+  }
+
+  // the coarse clock is read again when the value enters the window before its next update
+  uint64_t nspt = tsc_tick::get_cyc2ns().nanoseconds_per_tick_shifted;
+  int64_t  gap  = coarse + resolution - a.window - ns;
+  a.ticks       = ticks;
+  a.nanoseconds = ns;
+  a.coarse      = coarse;
+  a.max_ticks   = gap > 0 ? (uint64_t) (((__int128_t) gap << 32) / (int64_t) nspt) : 0;
+  a.nanoseconds_per_tick_shifted = nspt;
+  return returned(a, ns);
+}
+
+#endif // HAVE_TSC_COARSE
@@ -0,0 +1,81 @@
+#include "interface/x86_tsc_monotonic.h"
+
+#ifdef CHRONO_HAVE_TSC
+
+seqlock<tsc_monotonic::parameters> tsc_monotonic::params;
+std::atomic_flag                   tsc_monotonic::writer = ATOMIC_FLAG_INIT;
+std::atomic<int64_t>               tsc_monotonic::resync_interval { 1000000000 };   // 1 s
+
+// previous sample, only accessed by the thread holding the writer flag
+static tsc_sample previous_sample;
+
+static const int64_t max_step_nanoseconds = 1000000;   // 1 ms
+static const int64_t max_slew_ppm         = 500;
+
+static int64_t monotonic_nanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t clamp(int64_t value, int64_t low, int64_t high)
+{
+  return value < low ? low : value > high ? high : value;
+}
+
+void tsc_monotonic::resync() noexcept
+{
+  if (writer.test_and_set(std::memory_order_acquire))
+    return;
+
+  tsc_sample sample   = sample_tsc(monotonic_nanoseconds);
+  int64_t    ticks    = (int64_t) sample.ticks;
+  int64_t    nominal  = tsc_tick::get().nanoseconds_per_tick_shifted;
+  int64_t    interval = resync_interval.load(std::memory_order_relaxed);
+
+  parameters p;
+  if (params.load(p) == 0) {
+    // first segment: start from the sampled time, at the nominal TSC rate
+    p.anchor_ticks                          = ticks;
+    p.anchor_nanoseconds                    = sample.nanoseconds;
+    p.anchor_fraction                       = 0;
+    p.nanoseconds_per_tick_shifted          = nominal;
+    p.previous_nanoseconds_per_tick_shifted = nominal;
+  } else {
+    // time of the current segment at the new anchor, keeping the sub-nanosecond part
+    int64_t    delta   = ticks - p.anchor_ticks;
+    int64_t    slope   = delta >= 0 ? p.nanoseconds_per_tick_shifted : p.previous_nanoseconds_per_tick_shifted;
+    __int128_t shifted = (__int128_t) delta * slope + p.anchor_fraction;
+    int64_t    ns      = p.anchor_nanoseconds + (int64_t) (shifted >> 32);
+    int64_t    offset  = sample.nanoseconds - ns;
+
+    // rate of CLOCK_MONOTONIC with respect to the TSC since the previous sample, which includes the
+    // frequency adjustment currently applied by NTP, within the range the kernel allows
+    int64_t rate = nominal;
+    if (ticks > (int64_t) previous_sample.ticks)
+      rate = (int64_t) (((__int128_t) (sample.nanoseconds - previous_sample.nanoseconds) << 32) / (ticks - (int64_t) previous_sample.ticks));
+    rate = clamp(rate, nominal - nominal * max_slew_ppm / 1000000, nominal + nominal * max_slew_ppm / 1000000);
+
+    p.anchor_ticks                          = ticks;
+    p.previous_nanoseconds_per_tick_shifted = slope;
+    if (offset > max_step_nanoseconds) {
+      // too far behind, step forward
+      p.anchor_nanoseconds                  = sample.nanoseconds;
+      p.anchor_fraction                     = 0;
+      p.nanoseconds_per_tick_shifted        = rate;
+    } else {
+      // cancel the offset over the next interval, slewing by at most max_slew_ppm
+      int64_t correction = (int64_t) (((__int128_t) offset << 32) / interval * rate >> 32);
+      correction = clamp(correction, - rate * max_slew_ppm / 1000000, rate * max_slew_ppm / 1000000);
+      p.anchor_nanoseconds                  = ns;
+      p.anchor_fraction                     = (int64_t) (shifted & 0xffffffff);
+      p.nanoseconds_per_tick_shifted        = rate + correction;
+    }
+  }
+  p.next_resync = ticks + (int64_t) (((__int128_t) interval << 32) / p.nanoseconds_per_tick_shifted);
+  params.store(p);
+  previous_sample = sample;
+
+  writer.clear(std::memory_order_release);
+}
+
+#endif // CHRONO_HAVE_TSC
@@ -0,0 +1,56 @@
+#include "interface/x86_tsc_realtime.h"
+
+#ifdef CHRONO_HAVE_TSC
+
+seqlock<tsc_realtime::anchor> tsc_realtime::params;
+std::atomic_flag              tsc_realtime::writer = ATOMIC_FLAG_INIT;
+std::atomic<int64_t>          tsc_realtime::resync_interval { 100000000 };     // 100 ms
+
+static int64_t realtime_nanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void tsc_realtime::resync() noexcept
+{
+  if (writer.test_and_set(std::memory_order_acquire))
+    return;
+
+  // read the generation first: if the frequency changes in the meantime, the next reader resyncs again
+  uint32_t             generation = tsc_tick::generation();
+  tsc_sample           sample     = sample_tsc(realtime_nanoseconds);
+  int64_t              ticks      = (int64_t) sample.ticks;
+
+  // the scale of tsc_realtime_tick is taken from the first anchor, and kept by the next ones
+  anchor a;
+  if (params.load(a) == 0) {
+    tsc_tick::parameters p = tsc_tick::get();
+    a.ticks_per_second = p.ticks_per_second;
+    a.cyc2ns           = cyc2ns_data { (uint64_t) p.nanoseconds_per_tick_shifted, p.max_ticks, 0, 0, 0 };
+    a.ns2cyc           = ns2cyc_data { (uint64_t) p.ticks_per_nanosecond_shifted, p.max_nanoseconds };
+  }
+
+  // the inverse of the conversion to nanoseconds, rounded to the nearest tick, so that the wall-clock
+  // time of the sample converts back to itself within a nanosecond
+  __int128_t shifted   = (__int128_t) sample.nanoseconds << 32;
+  __int128_t rate      = (__int128_t) a.cyc2ns.nanoseconds_per_tick_shifted;
+  int64_t    realtime  = (int64_t) ((shifted + rate / 2) / rate);
+
+  a.offset_nanoseconds = sample.nanoseconds - tsc_tick::to_timestamp(ticks);
+  a.offset_ticks       = realtime - ticks;
+  a.next_resync        = ticks + tsc_tick::from_nanoseconds(resync_interval.load(std::memory_order_relaxed));
+  a.generation         = generation;
+  params.store(a);
+
+  writer.clear(std::memory_order_release);
+}
+
+// the values before 1970 are converted with a signed 128-bit multiply as well
+int64_t tsc_realtime::to_timestamp_far(int64_t ticks) noexcept
+{
+  cyc2ns_data c = get_cyc2ns();
+  __int128_t shifted = (__int128_t) (ticks - c.epoch_ticks) * (int64_t) c.nanoseconds_per_tick_shifted + (int64_t) c.epoch_fraction;
+  return c.epoch_nanoseconds + (int64_t) (shifted >> 32);
+}
+
+#endif // CHRONO_HAVE_TSC
@@ -0,0 +1,200 @@
+#include "interface/x86_tsc_sync.h"
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+
+// C++ standard headers
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <thread>
+
+// for lfence and pause
+#include <emmintrin.h>
+
+// POSIX headers
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+  // round number used to tell the responder to give up
+  const uint32_t abort_round = std::numeric_limits<uint32_t>::max();
+
+  // each side of the ping-pong writes to its own cache line
+  struct alignas(64) ping_line {
+    std::atomic<uint32_t> round;
+  };
+
+  struct alignas(64) pong_line {
+    std::atomic<uint64_t> ticks;        // t2, or 0 if the responder was not on the expected CPU
+    std::atomic<uint32_t> round;
+  };
+
+  struct ping_pong {
+    ping_line             ping;
+    pong_line             pong;
+    std::atomic<int>      ready;        // 1 once the responder is pinned, -1 if it could not be pinned
+  };
+
+  bool pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(& set);
+    CPU_SET(cpu, & set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), & set) == 0;
+  }
+
+  // read the TSC and the CPU it was read on; the lfence keeps the following instructions from
+  // starting before the TSC has been read
+  inline uint64_t read_tsc(int & cpu) {
+    uint32_t aux;
+    uint64_t ticks = rdtscp(& aux);
+    _mm_lfence();
+    cpu = (int) (aux & 0xfff);
+    return ticks;
+  }
+
+  void responder(ping_pong & shared, int cpu, unsigned rounds) {
+    if (! pin_to_cpu(cpu)) {
+      shared.ready.store(-1, std::memory_order_release);
+      return;
+    }
+    shared.ready.store(1, std::memory_order_release);
+
+    for (uint32_t round = 1; round <= rounds; ++round) {
+      uint32_t seen;
+      while ((seen = shared.ping.round.load(std::memory_order_acquire)) != round) {
+        if (seen == abort_round)
+          return;
+        _mm_pause();
+      }
+      int      on;
+      uint64_t t2 = read_tsc(on);
+      shared.pong.ticks.store(on == cpu ? t2 : 0, std::memory_order_relaxed);
+      shared.pong.round.store(round, std::memory_order_release);
+    }
+  }
+
+  bool initiator(ping_pong & shared, int cpu, unsigned rounds, tsc_offset_bounds & bounds) {
+    bool pinned = pin_to_cpu(cpu);
+    int  ready;
+    while ((ready = shared.ready.load(std::memory_order_acquire)) == 0)
+      std::this_thread::yield();
+    if (! pinned || ready < 0) {
+      shared.ping.round.store(abort_round, std::memory_order_release);
+      return false;
+    }
+
+    for (uint32_t round = 1; round <= rounds; ++round) {
+      int      on1, on3;
+      uint64_t t1 = read_tsc(on1);
+      shared.ping.round.store(round, std::memory_order_release);
+      while (shared.pong.round.load(std::memory_order_acquire) != round)
+        _mm_pause();
+      uint64_t t3 = read_tsc(on3);
+      uint64_t t2 = shared.pong.ticks.load(std::memory_order_relaxed);
+
+      // discard the rounds where either thread was not on the expected CPU
+      if (on1 != cpu || on3 != cpu || t2 == 0)
+        continue;
+      int64_t lower = (int64_t) (t2 - t3);
+      int64_t upper = (int64_t) (t2 - t1);
+      if (lower > bounds.lower)
+        bounds.lower = lower;
+      if (upper < bounds.upper)
+        bounds.upper = upper;
+      ++bounds.samples;
+    }
+    return true;
+  }
+
+  // CPUs the process is allowed to run on
+  std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(& set);
+    if (sched_getaffinity(0, sizeof(set), & set) != 0)
+      return cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+      if (CPU_ISSET(cpu, & set))
+        cpus.push_back(cpu);
+    return cpus;
+  }
+
+} // namespace
+
+
+bool measure_tsc_offset(int cpu_a, int cpu_b, unsigned rounds, tsc_offset_bounds & bounds)
+{
+  bounds.lower   = std::numeric_limits<int64_t>::min();
+  bounds.upper   = std::numeric_limits<int64_t>::max();
+  bounds.samples = 0;
+
+  ping_pong shared;
+  shared.ping.round.store(0);
+  shared.pong.ticks.store(0);
+  shared.pong.round.store(0);
+  shared.ready.store(0);
+
+  bool pinned = false;
+  std::thread b(responder, std::ref(shared), cpu_b, rounds);
+  std::thread a([&] { pinned = initiator(shared, cpu_a, rounds, bounds); });
+  a.join();
+  b.join();
+
+  return pinned && bounds.samples > 0;
+}
+
+
+tsc_sync_report check_tsc_sync(unsigned rounds, int64_t tolerance)
+{
+  tsc_sync_report report;
+  report.cpus         = allowed_cpus();
+  report.synchronized = true;
+
+  size_t n = report.cpus.size();
+  report.offsets.assign(n * n, tsc_offset_bounds { 0, 0, 0 });
+  for (size_t i = 0; i < n; ++i) {
+    report.offsets[i * n + i] = tsc_offset_bounds { 0, 0, rounds };
+    for (size_t j = i + 1; j < n; ++j) {
+      tsc_offset_bounds & bounds  = report.offsets[i * n + j];
+      tsc_offset_bounds & reverse = report.offsets[j * n + i];
+      bool valid = measure_tsc_offset(report.cpus[i], report.cpus[j], rounds, bounds);
+      if (valid) {
+        reverse.lower   = - bounds.upper;
+        reverse.upper   = - bounds.lower;
+        reverse.samples = bounds.samples;
+      } else {
+        reverse = bounds;
+      }
+      // without a valid measurement there is no evidence that the TSCs are synchronized
+      if (! valid || bounds.lower > tolerance || bounds.upper < - tolerance)
+        report.synchronized = false;
+    }
+  }
+  return report;
+}
+
+
+alignas(64) int64_t tsc_cpu_offsets::table[tsc_cpu_offsets::max_cpus];
+
+bool tsc_cpu_offsets::measure(unsigned rounds)
+{
+  std::vector<int> cpus = allowed_cpus();
+  if (cpus.empty())
+    return false;
+
+  bool complete = true;
+  table[cpus[0] & (max_cpus - 1)] = 0;
+  for (size_t i = 1; i < cpus.size(); ++i) {
+    tsc_offset_bounds bounds;
+    int64_t offset = 0;
+    if (! measure_tsc_offset(cpus[0], cpus[i], rounds, bounds))
+      complete = false;
+    else if (bounds.lower > 0 || bounds.upper < 0)
+      offset = bounds.lower + (bounds.upper - bounds.lower) / 2;
+    table[cpus[i] & (max_cpus - 1)] = offset;
+  }
+  return complete;
+}
+
+#endif // CHRONO_HAVE_TSC_SYNC
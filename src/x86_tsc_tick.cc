@@ -1,12 +1,258 @@
+// C++ standard headers
+#include <condition_variable>
+#include <cstdlib>
+#include <thread>
+
 #include "interface/x86_tsc.h"
 #include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_cache.h"
+#include "interface/perf_event_time.h"
+#include "interface/linear_regression.h"
 
 #ifdef CHRONO_HAVE_TSC
 
-const double  tsc_tick::ticks_per_second = calibrate_tsc_hz();
-const double  tsc_tick::seconds_per_tick = 1. / tsc_tick::ticks_per_second;
-const int64_t tsc_tick::nanoseconds_per_tick_shifted = (1000000000ll << 32) / tsc_tick::ticks_per_second;
-//const int64_t tsc_tick::ticks_per_nanosecond_shifted = (int64_t) ((((__int128_t) tsc_tick::ticks_per_second) << 32) / 1000000000ll);
-const int64_t tsc_tick::ticks_per_nanosecond_shifted = (int64_t) llrint(tsc_tick::ticks_per_second * 4.294967296);
+seqlock<tsc_counter::parameters> tsc_counter::params;
+seqlock<cyc2ns_data>             tsc_counter::cyc2ns;
+seqlock<ns2cyc_data>             tsc_counter::ns2cyc;
+std::atomic<uint32_t>            tsc_counter::frequency_generation;
+std::once_flag                   tsc_counter::calibrated_once;
+
+// serialise the writers of tsc_counter::params
+static std::mutex parameters_mutex;
+
+// largest values that can be converted with a 64-bit multiply, leaving room for the rounding
+// and for the fraction of the epoch
+static void set_limits(tsc_tick::parameters & p)
+{
+  p.max_ticks       = (UINT64_MAX - 0xffffffff) / (uint64_t) p.nanoseconds_per_tick_shifted;
+  p.max_nanoseconds = (UINT64_MAX - 0xffffffff) / (uint64_t) p.ticks_per_nanosecond_shifted;
+}
+
+// timestamp of a TSC value, including its sub-nanosecond part, with a 128-bit multiply
+static void timestamp(tsc_tick::parameters const & p, int64_t ticks, int64_t & ns, int64_t & fraction)
+{
+  __int128_t shifted = (__int128_t) (ticks - p.epoch_ticks) * p.nanoseconds_per_tick_shifted + p.epoch_fraction;
+  ns       = p.epoch_nanoseconds + (int64_t) (shifted >> 32);
+  fraction = (int64_t) (shifted & 0xffffffff);
+}
+
+// use the same conversion as the kernel, if it is available
+static bool read_perf_event_parameters(tsc_tick::parameters & p)
+{
+#ifdef HAVE_PERF_EVENT_TIME
+  perf_event_time_parameters perf;
+  if (!has_tsc() || !tsc_allowed() || !read_perf_event_time_parameters(perf))
+    return false;
+
+  // the epoch at 0 is time_zero, with no fraction
+  perf_event_time_conversion c = perf_event_conversion(perf, 0);
+  p.ticks_per_second = c.ticks_per_second;
+  p.seconds_per_tick = c.seconds_per_tick;
+  p.nanoseconds_per_tick_shifted = (int64_t) c.cyc2ns.nanoseconds_per_tick_shifted;
+  p.ticks_per_nanosecond_shifted = (int64_t) c.ns2cyc.ticks_per_nanosecond_shifted;
+  p.epoch_ticks = c.cyc2ns.epoch_ticks;
+  p.epoch_nanoseconds = c.cyc2ns.epoch_nanoseconds;
+  p.epoch_fraction = (int64_t) c.cyc2ns.epoch_fraction;
+  p.max_ticks = c.cyc2ns.max_ticks;
+  p.max_nanoseconds = c.ns2cyc.max_nanoseconds;
+  p.error_ppm = 0.;
+  p.source = tsc_frequency_source::perf_event;
+  return true;
+#else
+  return false;
+#endif // HAVE_PERF_EVENT_TIME
+}
+
+// set the frequency dependent parameters
+static void set_frequency(tsc_tick::parameters & p, double ticks_per_second)
+{
+  p.ticks_per_second = ticks_per_second;
+  p.seconds_per_tick = 1. / ticks_per_second;
+  p.nanoseconds_per_tick_shifted = (1000000000ll << 32) / ticks_per_second;
+  //p.ticks_per_nanosecond_shifted = (int64_t) ((((__int128_t) ticks_per_second) << 32) / 1000000000ll);
+  p.ticks_per_nanosecond_shifted = (int64_t) llrint(ticks_per_second * 4.294967296);
+  set_limits(p);
+}
+
+// read or measure the TSC frequency; the precision and the time limit of the calibration can be
+// tuned with the CHRONO_TSC_CALIBRATION_PPM and CHRONO_TSC_CALIBRATION_MS environment variables
+static void read_tsc_parameters(tsc_tick::parameters & p)
+{
+  double target_ppm = 1.;
+  long   max_time   = 1000;
+  const char * value;
+  if ((value = getenv("CHRONO_TSC_CALIBRATION_PPM")) && atof(value) > 0.)
+    target_ppm = atof(value);
+  if ((value = getenv("CHRONO_TSC_CALIBRATION_MS")) && atol(value) > 0)
+    max_time = atol(value);
+
+  tsc_calibration calibration = discover_tsc_frequency(target_ppm, std::chrono::milliseconds(max_time));
+  set_frequency(p, calibration.hz);
+  p.epoch_ticks = 0;
+  p.epoch_nanoseconds = 0;
+  p.epoch_fraction = 0;
+  p.error_ppm = calibration.error_ppm;
+  p.source = calibration.source;
+}
+
+void tsc_counter::calibrate()
+{
+  std::call_once(calibrated_once, [] {
+    parameters p;
+    // the perf_event parameters are cheap to read, and are not cached
+    if (!read_perf_event_parameters(p)) {
+      bool cached = false;
+#ifdef CHRONO_HAVE_TSC_CACHE
+      // reuse the parameters computed by an earlier process during the same boot, if the cache is enabled
+      std::string cache = tsc_cache_path();
+      cached = !cache.empty() && read_tsc_cache(cache, p);
+#endif // CHRONO_HAVE_TSC_CACHE
+
+      if (!cached) {
+        read_tsc_parameters(p);
+#ifdef CHRONO_HAVE_TSC_CACHE
+        if (!cache.empty() && p.source != tsc_frequency_source::none)
+          write_tsc_cache(cache, p);
+#endif // CHRONO_HAVE_TSC_CACHE
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(parameters_mutex);
+    store(p);
+  });
+}
+
+// the conversion subsets are published before the full parameters, so that get() returning valid
+// parameters implies that the conversions do not need to calibrate; the generation is incremented
+// after the subsets, so that the factors cached by runtime_tick are recomputed from the new ones
+void tsc_counter::store(parameters const & p) noexcept
+{
+  bool new_frequency = (cyc2ns.load().nanoseconds_per_tick_shifted != (uint64_t) p.nanoseconds_per_tick_shifted);
+  cyc2ns.store(cyc2ns_data { (uint64_t) p.nanoseconds_per_tick_shifted, p.max_ticks, p.epoch_ticks, p.epoch_nanoseconds, (uint64_t) p.epoch_fraction });
+  ns2cyc.store(ns2cyc_data { (uint64_t) p.ticks_per_nanosecond_shifted, p.max_nanoseconds });
+  params.store(p);
+  if (new_frequency)
+    frequency_generation.fetch_add(1, std::memory_order_release);
+}
+
+
+// publish a refined frequency, keeping the timestamps continuous at the current time
+void tsc_counter::publish_frequency(double ticks_per_second, double error_ppm)
+{
+  std::lock_guard<std::mutex> lock(parameters_mutex);
+  parameters p = get();
+  int64_t ticks = rdtsc();
+  int64_t ns, fraction;
+  timestamp(p, ticks, ns, fraction);
+  set_frequency(p, ticks_per_second);
+  p.epoch_ticks = ticks;
+  p.epoch_nanoseconds = ns;
+  p.epoch_fraction = fraction;
+  p.error_ppm = error_ppm;
+  store(p);
+}
+
+// move the epoch forward to the given TSC value, unless another thread is updating the parameters;
+// the sub-nanosecond part is kept, so the timestamps are the same as with the previous epoch
+int64_t tsc_counter::to_timestamp_far(int64_t ticks) noexcept
+{
+  parameters p = get();
+  int64_t ns, fraction;
+  timestamp(p, ticks, ns, fraction);
+  if (ticks > p.epoch_ticks) {
+    std::unique_lock<std::mutex> lock(parameters_mutex, std::try_to_lock);
+    if (lock.owns_lock()) {
+      // check that the parameters have not been changed in the meantime
+      parameters current = get();
+      if (current.epoch_ticks == p.epoch_ticks && current.nanoseconds_per_tick_shifted == p.nanoseconds_per_tick_shifted) {
+        p.epoch_ticks = ticks;
+        p.epoch_nanoseconds = ns;
+        p.epoch_fraction = fraction;
+        store(p);
+      }
+    }
+  }
+  return ns;
+}
+
+namespace {
+
+  struct refinement_thread {
+    std::mutex              mutex;
+    std::condition_variable wakeup;
+    std::thread             thread;
+    bool                    stop = false;
+
+    void join()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!thread.joinable())
+          return;
+        stop = true;
+      }
+      wakeup.notify_all();
+      thread.join();
+    }
+
+    ~refinement_thread()
+    {
+      join();
+    }
+  };
+
+  refinement_thread & refinement()
+  {
+    static refinement_thread instance;
+    return instance;
+  }
+
+} // namespace
+
+// keep extending the regression of the TSC against the reference clock, and publish the
+// new frequency whenever its estimated error improves on the current one
+void tsc_counter::refine(std::chrono::milliseconds interval)
+{
+  refinement_thread & r = refinement();
+  linear_regression fit;
+  tsc_sample first = sample_tsc();
+
+  std::unique_lock<std::mutex> lock(r.mutex);
+  while (!r.wakeup.wait_for(lock, interval, [&r] { return r.stop; })) {
+    tsc_sample sample = sample_tsc();
+    fit.add((double) (sample.nanoseconds - first.nanoseconds) * 1.e-9, (double) (sample.ticks - first.ticks));
+
+    double ticks_per_second = fit.slope();
+    double error_ppm = fit.slope_error() / ticks_per_second * 1.e6;
+    if (std::isnan(error_ppm))
+      continue;
+    // a frequency with an unknown error (e.g. a nominal one, like those of CPUID 0x15 and 0x16) is
+    // replaced by the first fit
+    double current = estimated_error();
+    if (std::isnan(current) || error_ppm < current)
+      publish_frequency(ticks_per_second, error_ppm);
+  }
+}
+
+bool tsc_counter::start_refinement(std::chrono::milliseconds interval)
+{
+  // the kernel's parameters, the only ones with an error of 0, must not be changed
+  parameters p = get();
+  if (p.source == tsc_frequency_source::none || p.source == tsc_frequency_source::perf_event)
+    return false;
+
+  refinement_thread & r = refinement();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (r.thread.joinable())
+    return true;
+  r.stop = false;
+  r.thread = std::thread(refine, interval);
+  return true;
+}
+
+void tsc_counter::stop_refinement()
+{
+  refinement().join();
+}
 
 #endif
@@ -0,0 +1,18 @@
+// C++ standard headers
+#include <cmath>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_tick_fixed.h"
+
+bool check_tsc_fixed_frequency(uint64_t hz, double tolerance_ppm)
+{
+#ifdef CHRONO_HAVE_TSC
+  if (has_tsc() && tsc_allowed()) {
+    double measured  = tsc_tick::ticks_per_second();
+    double error_ppm = std::fabs(measured - (double) hz) / (double) hz * 1.e6;
+    return error_ppm <= tolerance_ppm;
+  }
+#endif // CHRONO_HAVE_TSC
+  return false;
+}
@@ -0,0 +1,104 @@
+// measure the throughput of the batch conversions of tsc_tick, compared to converting one value at
+// a time, and check that they give the same results
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/batch_conversion.h"
+
+#if defined(CHRONO_HAVE_TSC)
+
+// best time over a few repetitions, in seconds
+template <typename F>
+static double measure(F f) {
+  double best = 1.e9;
+  for (int repeat = 0; repeat < 10; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop  = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count());
+  }
+  return best;
+}
+
+template <typename T, typename U, typename Single, typename Batch>
+static void compare(const char * name, std::vector<T> const & in, Single single, Batch batch) {
+  std::vector<U> expected(in.size());
+  std::vector<U> results(in.size());
+  double time_single = measure([&] { for (size_t i = 0; i < in.size(); ++i) expected[i] = single(in[i]); });
+  double time_batch  = measure([&] { batch(in.data(), results.data(), in.size()); });
+
+  std::cout << std::left << std::setw(20) << name << std::right
+            << std::setw(12) << in.size() / time_single / 1.e6 << " M/s"
+            << std::setw(12) << in.size() / time_batch / 1.e6 << " M/s"
+            << std::setw(10) << time_single / time_batch << "x" << std::endl;
+  if (results != expected) {
+    std::cerr << "error: the batch " << name << " differs from the conversion of single values" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+int main(void) {
+  const size_t size = 1 << 20;
+  std::mt19937_64 random(42);
+
+  tsc_tick::calibrate();
+  double tps = tsc_tick::ticks_per_second();
+
+  // intervals up to 1 second, plus a few arbitrary values to check the 128-bit fallback
+  std::vector<int64_t> ticks(size);
+  std::uniform_int_distribution<int64_t> interval(0, (int64_t) tps);
+  for (auto & t: ticks)
+    t = interval(random);
+  for (size_t i = 0; i < size; i += 1024)
+    ticks[i] = (int64_t) random();
+
+  std::vector<int64_t> nanoseconds(size);
+  std::uniform_int_distribution<int64_t> interval_ns(0, 1000000000ll);
+  for (auto & ns: nanoseconds)
+    ns = interval_ns(random);
+  for (size_t i = 0; i < size; i += 1024)
+    nanoseconds[i] = (int64_t) random();
+
+  std::vector<double> ticks_d(ticks.begin(), ticks.end());
+  std::vector<double> seconds(size);
+  for (size_t i = 0; i < size; ++i)
+    seconds[i] = nanoseconds[i] * 1.e-9;
+
+  std::cout << "batch conversions using the " << batch_conversion_kernel() << " kernel, on a single core" << std::endl;
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::left << std::setw(20) << "conversion" << std::right
+            << std::setw(16) << "single values" << std::setw(16) << "batch" << std::setw(11) << "speedup" << std::endl;
+
+  compare<int64_t, int64_t>("to_nanoseconds", ticks,
+      [](int64_t t) { return tsc_tick::to_nanoseconds(t); },
+      [](const int64_t * in, int64_t * out, size_t n) { tsc_tick::to_nanoseconds(in, out, n); });
+  compare<int64_t, int64_t>("from_nanoseconds", nanoseconds,
+      [](int64_t ns) { return tsc_tick::from_nanoseconds(ns); },
+      [](const int64_t * in, int64_t * out, size_t n) { tsc_tick::from_nanoseconds(in, out, n); });
+  compare<double, double>("to_seconds", ticks_d,
+      [](double t) { return tsc_tick::to_seconds(t); },
+      [](const double * in, double * out, size_t n) { tsc_tick::to_seconds(in, out, n); });
+  compare<double, double>("from_seconds", seconds,
+      [tps](double s) { return s * tps; },
+      [](const double * in, double * out, size_t n) { tsc_tick::from_seconds(in, out, n); });
+
+  return 0;
+}
+
+#else
+
+int main(void) {
+  std::cout << "TSC not available" << std::endl;
+  return 0;
+}
+
+#endif // defined(CHRONO_HAVE_TSC)
@@ -100,7 +100,7 @@ public:
   // perform the measurements
   virtual void sample() = 0;
 
-  void measure() {
+  virtual void measure() {
     sample();
     start = std::chrono::high_resolution_clock::now();
     sample();
@@ -113,6 +113,9 @@ public:
   // print a report
   virtual void report() = 0;
 
+  // print the characteristics that only some timers have, at the end of the report
+  virtual void report_details() { }
+
 protected:
   std::chrono::high_resolution_clock::time_point    start;
   std::chrono::high_resolution_clock::time_point    stop;
@@ -220,6 +223,7 @@ public:
       measure_work(100000);
     */
 
+    report_details();
     std::cout << std::endl;
   }
 
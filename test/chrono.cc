@@ -45,6 +45,7 @@
 #include "interface/syscall_clock_gettime.h"
 #include "interface/posix_clock.h"
 #include "interface/posix_clock_gettime.h"
+#include "interface/vdso_clock.h"
 #include "interface/posix_gettimeofday.h"
 #include "interface/posix_times.h"
 #include "interface/posix_times_f.h"
@@ -57,13 +58,77 @@
 #include "interface/boost_timer.h"
 #include "interface/tbb_tick_count.h"
 #include "interface/omp_get_wtime.h"
+#include "interface/cached_clock.h"
 
 #include "interface/native/mach_absolute_time.h"
+#include "interface/native/perf_time_clock.h"
 #include "interface/native/x86_tsc_clock.h"
 
 #include "benchmark.h"
 
 
+// adapt the clocks with a clock id only known at run time to the static interface of the benchmarks
+#ifdef HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+struct clock_dynamic_thread_cputime : public dynamic_posix_clock
+{
+  static const dynamic_posix_clock clock;
+
+  static time_point now() noexcept
+  {
+    return clock.now();
+  }
+};
+
+// the benchmarks run in the main thread
+const dynamic_posix_clock clock_dynamic_thread_cputime::clock = dynamic_posix_clock::thread_cputime(pthread_self());
+#endif // HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+
+#ifdef HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
+struct clock_dynamic_process_cputime : public dynamic_posix_clock
+{
+  static const dynamic_posix_clock clock;
+
+  static time_point now() noexcept
+  {
+    return clock.now();
+  }
+};
+
+const dynamic_posix_clock clock_dynamic_process_cputime::clock = dynamic_posix_clock::process_cputime(getpid());
+#endif // HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
+
+
+// run the ticker of a cached clock only during its own measurements, so that it does not disturb
+// the other benchmarks, and report the largest age of the values it returned
+template <typename Source>
+class CachedBenchmark : public Benchmark<clock_cached<Source>> {
+public:
+  CachedBenchmark(std::string const & d) :
+    Benchmark<clock_cached<Source>>(d),
+    staleness()
+  {
+  }
+
+  void measure() {
+    clock_cached<Source>::start();
+    Benchmark<clock_cached<Source>>::measure();
+    staleness = clock_cached<Source>::staleness();
+    clock_cached<Source>::stop();
+  }
+
+  // the staleness is only measured between two updates of the ticker
+  void report_details() {
+    if (staleness.count() > 0)
+      std::cout << "\tLargest staleness:     " << std::right << std::setw(10) << to_nanoseconds(staleness) << " ns" << std::endl;
+    else
+      std::cout << "\tLargest staleness:     " << std::right << std::setw(10) << "n/a" << " (no update during the measurements)" << std::endl;
+  }
+
+private:
+  std::chrono::nanoseconds staleness;
+};
+
+
 void init_timers(std::vector<BenchmarkBase *> & timers) 
 {
   // std::chrono timers
@@ -96,6 +161,18 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
   if (clock_syscall_boottime::is_available)
     timers.push_back(new Benchmark<clock_syscall_boottime>("syscall(SYS_clock_gettime, CLOCK_BOOTTIME)"));
 #endif // HAVE_SYSCALL_CLOCK_BOOTTIME
+#ifdef HAVE_SYSCALL_CLOCK_BOOTTIME_ALARM
+  if (clock_syscall_boottime_alarm::is_available)
+    timers.push_back(new Benchmark<clock_syscall_boottime_alarm>("syscall(SYS_clock_gettime, CLOCK_BOOTTIME_ALARM)"));
+#endif // HAVE_SYSCALL_CLOCK_BOOTTIME_ALARM
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME_ALARM
+  if (clock_syscall_realtime_alarm::is_available)
+    timers.push_back(new Benchmark<clock_syscall_realtime_alarm>("syscall(SYS_clock_gettime, CLOCK_REALTIME_ALARM)"));
+#endif // HAVE_SYSCALL_CLOCK_REALTIME_ALARM
+#ifdef HAVE_SYSCALL_CLOCK_TAI
+  if (clock_syscall_tai::is_available)
+    timers.push_back(new Benchmark<clock_syscall_tai>("syscall(SYS_clock_gettime, CLOCK_TAI)"));
+#endif // HAVE_SYSCALL_CLOCK_TAI
 #ifdef HAVE_SYSCALL_CLOCK_PROCESS_CPUTIME_ID
   if (clock_syscall_process_cputime::is_available)
     timers.push_back(new Benchmark<clock_syscall_process_cputime>("syscall(SYS_clock_gettime, CLOCK_PROCESS_CPUTIME_ID)"));
@@ -118,10 +195,18 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
   if (clock_gettime_monotonic::is_available)
     timers.push_back(new Benchmark<clock_gettime_monotonic>("clock_gettime(CLOCK_MONOTONIC)"));
 #endif // HAVE_POSIX_CLOCK_MONOTONIC
+#ifdef HAVE_VDSO_CLOCK
+  if (clock_vdso_monotonic::is_direct())
+    timers.push_back(new Benchmark<clock_vdso_monotonic>("CLOCK_MONOTONIC read from the vDSO data page"));
+#endif // HAVE_VDSO_CLOCK
 #ifdef HAVE_POSIX_CLOCK_MONOTONIC_COARSE
   if (clock_gettime_monotonic_coarse::is_available)
     timers.push_back(new Benchmark<clock_gettime_monotonic_coarse>("clock_gettime(CLOCK_MONOTONIC_COARSE)"));
 #endif // HAVE_POSIX_CLOCK_MONOTONIC_COARSE
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC
+  if (clock_cached<clock_gettime_monotonic>::is_available)
+    timers.push_back(new CachedBenchmark<clock_gettime_monotonic>("clock_gettime(CLOCK_MONOTONIC) cached by a 1 ms ticker"));
+#endif // HAVE_POSIX_CLOCK_MONOTONIC
 #ifdef HAVE_POSIX_CLOCK_MONOTONIC_RAW
   if (clock_gettime_monotonic_raw::is_available)
     timers.push_back(new Benchmark<clock_gettime_monotonic_raw>("clock_gettime(CLOCK_MONOTONIC_RAW)"));
@@ -130,6 +215,18 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
   if (clock_gettime_boottime::is_available)
     timers.push_back(new Benchmark<clock_gettime_boottime>("clock_gettime(CLOCK_BOOTTIME)"));
 #endif // HAVE_POSIX_CLOCK_BOOTTIME
+#ifdef HAVE_POSIX_CLOCK_BOOTTIME_ALARM
+  if (clock_gettime_boottime_alarm::is_available)
+    timers.push_back(new Benchmark<clock_gettime_boottime_alarm>("clock_gettime(CLOCK_BOOTTIME_ALARM)"));
+#endif // HAVE_POSIX_CLOCK_BOOTTIME_ALARM
+#ifdef HAVE_POSIX_CLOCK_REALTIME_ALARM
+  if (clock_gettime_realtime_alarm::is_available)
+    timers.push_back(new Benchmark<clock_gettime_realtime_alarm>("clock_gettime(CLOCK_REALTIME_ALARM)"));
+#endif // HAVE_POSIX_CLOCK_REALTIME_ALARM
+#ifdef HAVE_POSIX_CLOCK_TAI
+  if (clock_gettime_tai::is_available)
+    timers.push_back(new Benchmark<clock_gettime_tai>("clock_gettime(CLOCK_TAI)"));
+#endif // HAVE_POSIX_CLOCK_TAI
 #ifdef HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
   if (clock_gettime_process_cputime::is_available)
     timers.push_back(new Benchmark<clock_gettime_process_cputime>("clock_gettime(CLOCK_PROCESS_CPUTIME_ID)"));
@@ -138,6 +235,14 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
   if (clock_gettime_thread_cputime::is_available)
     timers.push_back(new Benchmark<clock_gettime_thread_cputime>("clock_gettime(CLOCK_THREAD_CPUTIME_ID)"));
 #endif // HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+#ifdef HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+  if (clock_dynamic_thread_cputime::clock.is_available())
+    timers.push_back(new Benchmark<clock_dynamic_thread_cputime>("clock_gettime(pthread_getcpuclockid(pthread_self()))"));
+#endif // HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+#ifdef HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
+  if (clock_dynamic_process_cputime::clock.is_available())
+    timers.push_back(new Benchmark<clock_dynamic_process_cputime>("clock_gettime(clock_getcpuclockid(getpid()))"));
+#endif // HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
 
   // POSIX gettimeofday
 #ifdef HAVE_GETTIMEOFDAY
@@ -198,9 +303,18 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
 #if defined(CHRONO_HAVE_TSC)
 // TSC is only available on x86
   
+  // calibrate the TSC up front, so the cost is not included in the first measurement
+  tsc_tick::calibrate();
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+  // measure the offsets between the TSCs of the different CPUs, for the compensated clocks
+  if (has_rdtscp() && tsc_allowed())
+    tsc_cpu_offsets::measure();
+#endif
+
   // read TSC clock frequency
   std::stringstream buffer;
-  buffer << std::fixed << std::setprecision(3) << (tsc_tick::ticks_per_second / 1.e6) << " MHz";
+  buffer << std::fixed << std::setprecision(3) << (tsc_tick::ticks_per_second() / 1.e6) << " MHz, " << tsc_frequency_source_name(tsc_tick::frequency_source());
   std::string tsc_freq = buffer.str();
 
   // x86 DST-based clock (via std::chrono::nanosecond)
@@ -213,9 +327,29 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
 #ifdef CHRONO_HAVE_RDTSCP
   if (clock_rdtscp::is_available)
     timers.push_back(new Benchmark<clock_rdtscp>("RDTSCP (" + tsc_freq + ") (using nanoseconds)"));
+#endif
+#ifdef CHRONO_HAVE_RDTSCP
+  if (clock_rdtscp_cpu::is_available)
+    timers.push_back(new Benchmark<clock_rdtscp_cpu>("RDTSCP with CPU and node (" + tsc_freq + ") (using nanoseconds)"));
+#endif
+#ifdef CHRONO_HAVE_RDPID
+  if (clock_rdpid_cpu::is_available)
+    timers.push_back(new Benchmark<clock_rdpid_cpu>("RDPID; RDTSC; RDPID with CPU and node (" + tsc_freq + ") (using nanoseconds)"));
+#endif
+#ifdef CHRONO_HAVE_TSC_SYNC
+  if (clock_rdtscp_compensated::is_available)
+    timers.push_back(new Benchmark<clock_rdtscp_compensated>("RDTSCP with per-CPU offset (" + tsc_freq + ") (using nanoseconds)"));
 #endif
   if (clock_serialising_rdtsc::is_available)
     timers.push_back(new Benchmark<clock_serialising_rdtsc>("run-time selected serialising RDTSC (" + tsc_freq + ") (using nanoseconds)"));
+  if (clock_tsc_realtime::is_available)
+    timers.push_back(new Benchmark<clock_tsc_realtime>("RDTSC + CLOCK_REALTIME offset (" + tsc_freq + ") (using nanoseconds)"));
+  if (clock_tsc_monotonic::is_available)
+    timers.push_back(new Benchmark<clock_tsc_monotonic>("RDTSC slewed to CLOCK_MONOTONIC (" + tsc_freq + ") (using nanoseconds)"));
+#ifdef HAVE_TSC_COARSE
+  if (clock_tsc_coarse::is_available)
+    timers.push_back(new Benchmark<clock_tsc_coarse>("CLOCK_MONOTONIC_COARSE interpolated with RDTSC (" + tsc_freq + ") (using nanoseconds)"));
+#endif // HAVE_TSC_COARSE
   // x86 DST-based clock (native)
   if (native::clock_rdtsc::is_available)
     timers.push_back(new Benchmark<native::clock_rdtsc>("RDTSC (" + tsc_freq + ") (native)"));
@@ -226,9 +360,29 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
 #ifdef CHRONO_HAVE_RDTSCP
   if (native::clock_rdtscp::is_available)
     timers.push_back(new Benchmark<native::clock_rdtscp>("RDTSCP (" + tsc_freq + ") (native)"));
+#endif
+#ifdef CHRONO_HAVE_RDTSCP
+  if (native::clock_rdtscp_cpu::is_available)
+    timers.push_back(new Benchmark<native::clock_rdtscp_cpu>("RDTSCP with CPU and node (" + tsc_freq + ") (native)"));
+#endif
+#ifdef CHRONO_HAVE_RDPID
+  if (native::clock_rdpid_cpu::is_available)
+    timers.push_back(new Benchmark<native::clock_rdpid_cpu>("RDPID; RDTSC; RDPID with CPU and node (" + tsc_freq + ") (native)"));
+#endif
+#ifdef CHRONO_HAVE_TSC_SYNC
+  if (native::clock_rdtscp_compensated::is_available)
+    timers.push_back(new Benchmark<native::clock_rdtscp_compensated>("RDTSCP with per-CPU offset (" + tsc_freq + ") (native)"));
 #endif
   if (native::clock_serialising_rdtsc::is_available)
     timers.push_back(new Benchmark<native::clock_serialising_rdtsc>("run-time selected serialising RDTSC (" + tsc_freq + ") (native)"));
+  if (native::clock_tsc_realtime::is_available)
+    timers.push_back(new Benchmark<native::clock_tsc_realtime>("RDTSC + CLOCK_REALTIME offset (" + tsc_freq + ") (native)"));
+#ifdef HAVE_PERF_TIME_TICK
+  if (native::clock_perf_time::is_available)
+    timers.push_back(new Benchmark<native::clock_perf_time>("RDTSC converted like the perf_event timestamps (" + tsc_freq + ") (native)"));
+#endif
+  if (clock_cached<native::clock_rdtsc>::is_available)
+    timers.push_back(new CachedBenchmark<native::clock_rdtsc>("RDTSC (" + tsc_freq + ") (native) cached by a 1 ms ticker"));
 
 #endif // defined(CHRONO_HAVE_TSC)
 
@@ -264,6 +418,33 @@ void init_timers(std::vector<BenchmarkBase *> & timers)
 }
 
 
+// compare the values of a clock with a reference clock read just before and just after it, and
+// report the distribution of the differences from the middle of the two reference values
+template <typename Clock, typename Reference>
+void report_error(std::string const & description, std::string const & reference) {
+  std::vector<double> errors(MEASURE_SIZE);
+  unsigned int outside = 0;
+  for (unsigned int i = 0; i < MEASURE_SIZE; ++i) {
+    double before = to_nanoseconds(Reference::now().time_since_epoch());
+    double value  = to_nanoseconds(Clock::now().time_since_epoch());
+    double after  = to_nanoseconds(Reference::now().time_since_epoch());
+    if (value < before || value > after)
+      ++outside;
+    errors[i] = value - (before + after) / 2.;
+  }
+  std::sort(errors.begin(), errors.end());
+  double max = std::max(- errors.front(), errors.back());
+
+  std::cout << std::setprecision(1) << std::fixed;
+  std::cout << "Error of " << description << " with respect to " << reference << std::endl;
+  std::cout << "\tMedian error:          " << std::right << std::setw(10) << median(errors) << " ns" << std::endl;
+  std::cout << "\tAverage error:         " << std::right << std::setw(10) << average(errors) << " ns (sigma: " << sigma(errors) << " ns)" << std::endl;
+  std::cout << "\tMaximum error:         " << std::right << std::setw(10) << max << " ns" << std::endl;
+  std::cout << "\tOutside the reference: " << std::right << std::setw(10) << 100. * outside / MEASURE_SIZE << " %" << std::endl;
+  std::cout << std::endl;
+}
+
+
 std::string read_kernel_version() {
 #if !defined(_WIN32)
   struct utsname names;
@@ -330,5 +511,13 @@ int main(void) {
     timer->report();
   }
 
+#if defined(HAVE_TSC_COARSE) && defined(HAVE_POSIX_CLOCK_MONOTONIC)
+  // accuracy of the interpolated coarse clock, and of the coarse clock itself
+  if (clock_tsc_coarse::is_available) {
+    report_error<clock_tsc_coarse, clock_gettime_monotonic>("CLOCK_MONOTONIC_COARSE interpolated with RDTSC", "clock_gettime(CLOCK_MONOTONIC)");
+    report_error<clock_gettime_monotonic_coarse, clock_gettime_monotonic>("clock_gettime(CLOCK_MONOTONIC_COARSE)", "clock_gettime(CLOCK_MONOTONIC)");
+  }
+#endif // defined(HAVE_TSC_COARSE) && defined(HAVE_POSIX_CLOCK_MONOTONIC)
+
   return 0;
 }
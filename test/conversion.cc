@@ -0,0 +1,196 @@
+// compare the cost and the results of the 64-bit (cyc2ns-style) conversions of tsc_tick with the
+// 128-bit multiply on the full set of parameters they replace, and of the conversions to coarser
+// periods with the conversion to nanoseconds followed by a division
+//
+// The conversions of tsc_tick_fixed<CHRONO_TSC_FIXED_HZ> are compared with the exact ones, and with
+// those of tsc_tick if the TSC runs at that frequency; set CHRONO_TSC_FIXED_HZ to the frequency of
+// the machine to run the comparison with tsc_tick there.
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_tick_fixed.h"
+#include "interface/native/native.h"
+
+#if defined(CHRONO_HAVE_TSC)
+
+#ifndef CHRONO_TSC_FIXED_HZ
+#define CHRONO_TSC_FIXED_HZ 2100000000
+#endif
+
+// the check of the frequency is tested separately, so the tolerance must accept any TSC frequency
+typedef tsc_tick_fixed<CHRONO_TSC_FIXED_HZ, 1000000000> fixed_tick;
+
+// reference implementations, using a 128-bit multiply for every conversion
+static int64_t to_nanoseconds_128(int64_t ticks) {
+  __int128_t shifted = (__int128_t) ticks * tsc_tick::get().nanoseconds_per_tick_shifted;
+  __int128_t ns = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
+  return (int64_t) ns;
+}
+
+static int64_t from_nanoseconds_128(int64_t ns) {
+  __int128_t shifted = (__int128_t) ns * tsc_tick::get().ticks_per_nanosecond_shifted;
+  __int128_t ticks = (shifted >> 32) + ((shifted & 0xffffffff) >= 0x80000000);
+  return (int64_t) ticks;
+}
+
+// the epoch of tsc_tick moves, so use a fixed one
+static tsc_tick::parameters reference;
+
+static int64_t to_timestamp_128(int64_t ticks) {
+  tsc_tick::parameters p = tsc_tick::get();
+  __int128_t shifted = (__int128_t) (ticks - reference.epoch_ticks) * p.nanoseconds_per_tick_shifted + reference.epoch_fraction;
+  return reference.epoch_nanoseconds + (int64_t) (shifted >> 32);
+}
+
+// conversion to nanoseconds followed by a division, as done before the per-period factors
+template <typename _Period>
+static int64_t to_period_128(int64_t ticks) {
+  std::chrono::nanoseconds d(to_nanoseconds_128(ticks));
+  return std::chrono::duration_cast<std::chrono::duration<int64_t, _Period>>(d).count();
+}
+
+// time a conversion over all the values, and return the average time per call in nanoseconds
+template <typename F>
+static double measure(F convert, std::vector<int64_t> const & values, std::vector<int64_t> & results) {
+  double best = 1.e9;
+  for (int repeat = 0; repeat < 10; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < values.size(); ++i)
+      results[i] = convert(values[i]);
+    auto stop  = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count() / values.size());
+  }
+  return best;
+}
+
+// exact conversions for the frequency of fixed_tick, rounded to the nearest value
+static int64_t fixed_to_nanoseconds_exact(int64_t ticks) {
+  __int128_t hz = CHRONO_TSC_FIXED_HZ;
+  return (int64_t) (((__int128_t) ticks * 2000000000 + hz) / (2 * hz));
+}
+
+static int64_t fixed_from_nanoseconds_exact(int64_t ns) {
+  __int128_t hz = CHRONO_TSC_FIXED_HZ;
+  return (int64_t) (((__int128_t) ns * 2 * hz + 1000000000) / 2000000000);
+}
+
+// truncated, like std::chrono::duration_cast
+static int64_t fixed_to_microseconds_exact(int64_t ticks) {
+  return (int64_t) ((__int128_t) ticks * 1000000 / CHRONO_TSC_FIXED_HZ);
+}
+
+template <typename F, typename G>
+static void compare(const char * name, F convert, G convert_128, std::vector<int64_t> const & values) {
+  std::vector<int64_t> results(values.size());
+  std::vector<int64_t> results_128(values.size());
+  double time     = measure(convert, values, results);
+  double time_128 = measure(convert_128, values, results_128);
+  int64_t max_difference = 0;
+  for (size_t i = 0; i < values.size(); ++i)
+    max_difference = std::max(max_difference, std::abs(results[i] - results_128[i]));
+
+  std::cout << std::left << std::setw(20) << name << std::right
+            << std::setw(10) << time << " ns" << std::setw(10) << time_128 << " ns"
+            << std::setw(14) << max_difference << std::endl;
+  if (max_difference > 1) {
+    std::cerr << "error: " << name << " differs from the 128-bit conversion by " << max_difference << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+int main(void) {
+  const size_t size = 1 << 20;
+  std::mt19937_64 random(42);
+
+  tsc_tick::calibrate();
+  reference = tsc_tick::get();
+  double tps = tsc_tick::ticks_per_second();
+
+  // intervals up to 1 second; much longer ones (a few seconds, depending on the frequency) fall
+  // back to the 128-bit multiply
+  std::vector<int64_t> ticks(size);
+  std::uniform_int_distribution<int64_t> interval(0, (int64_t) tps);
+  for (auto & t: ticks)
+    t = interval(random);
+
+  std::vector<int64_t> nanoseconds(size);
+  std::uniform_int_distribution<int64_t> interval_ns(0, 1000000000ll);
+  for (auto & ns: nanoseconds)
+    ns = interval_ns(random);
+
+  // increasing TSC values over the next 10 seconds, as a clock would read them
+  std::vector<int64_t> timestamps(size);
+  int64_t now = rdtsc();
+  for (size_t i = 0; i < size; ++i)
+    timestamps[i] = now + (int64_t) (10 * tps * i / size);
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::left << std::setw(20) << "conversion" << std::right
+            << std::setw(13) << "64-bit" << std::setw(13) << "128-bit" << std::setw(14) << "max diff" << std::endl;
+  compare("to_nanoseconds",   [](int64_t t)  { return tsc_tick::to_nanoseconds(t); },    to_nanoseconds_128,   ticks);
+  compare("from_nanoseconds", [](int64_t ns) { return tsc_tick::from_nanoseconds(ns); }, from_nanoseconds_128, nanoseconds);
+  compare("to_timestamp",     tsc_tick::to_timestamp,     to_timestamp_128,     timestamps);
+  compare("to microseconds",  [](int64_t t)  { return std::chrono::duration_cast<std::chrono::microseconds>(native::native_duration<int64_t, tsc_tick>(t)).count(); },
+                              to_period_128<std::micro>, ticks);
+  compare("to milliseconds",  [](int64_t t)  { return std::chrono::duration_cast<std::chrono::milliseconds>(native::native_duration<int64_t, tsc_tick>(t)).count(); },
+                              to_period_128<std::milli>, ticks);
+  std::cout << std::endl;
+
+  // conversions with a frequency known at compile time
+  std::cout << "tsc_tick_fixed<" << CHRONO_TSC_FIXED_HZ << ">" << std::endl;
+  std::cout << std::left << std::setw(20) << "conversion" << std::right
+            << std::setw(13) << "fixed" << std::setw(13) << "exact" << std::setw(14) << "max diff" << std::endl;
+  compare("to_nanoseconds",   [](int64_t t)  { return fixed_tick::to_nanoseconds(t); },    fixed_to_nanoseconds_exact,   ticks);
+  compare("from_nanoseconds", [](int64_t ns) { return fixed_tick::from_nanoseconds(ns); }, fixed_from_nanoseconds_exact, nanoseconds);
+  compare("to microseconds",  [](int64_t t)  { return std::chrono::duration_cast<std::chrono::microseconds>(native::native_duration<int64_t, fixed_tick>(t)).count(); },
+                              fixed_to_microseconds_exact, ticks);
+
+  // the conversions of tsc_tick_fixed and tsc_tick differ by the difference of their frequencies
+  double difference_ppm = (tps - CHRONO_TSC_FIXED_HZ) / CHRONO_TSC_FIXED_HZ * 1.e6;
+  if (std::fabs(difference_ppm) <= 100.) {
+    // skip the short intervals, where the rounding to whole nanoseconds dominates
+    double max_ppm = 0.;
+    for (int64_t t: ticks) {
+      if (t < tps / 10)
+        continue;
+      double fixed   = (double) fixed_tick::to_nanoseconds(t);
+      double runtime = (double) tsc_tick::to_nanoseconds(t);
+      max_ppm = std::max(max_ppm, std::fabs((fixed - runtime) / runtime * 1.e6 - difference_ppm));
+    }
+    std::cout << "compared with tsc_tick (" << difference_ppm << " ppm apart): " << max_ppm << " ppm max deviation" << std::endl;
+    if (max_ppm > 0.05) {
+      std::cerr << "error: tsc_tick_fixed differs from tsc_tick by " << max_ppm << " ppm more than their frequencies" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  } else {
+    std::cout << "comparison with tsc_tick skipped: the TSC frequency is " << tps / 1.e6 << " MHz" << std::endl;
+  }
+
+  // the check accepts the measured frequency, and rejects a different one
+  if (!fixed_tick::verify() || !check_tsc_fixed_frequency((uint64_t) std::llround(tps), 100.) || check_tsc_fixed_frequency((uint64_t) std::llround(tps * 1.01), 100.)) {
+    std::cerr << "error: check_tsc_fixed_frequency does not detect a mismatch of the TSC frequency" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::cout << "frequency check: ok" << std::endl;
+
+  return 0;
+}
+
+#else
+
+int main(void) {
+  std::cout << "TSC not available" << std::endl;
+  return 0;
+}
+
+#endif // defined(CHRONO_HAVE_TSC)
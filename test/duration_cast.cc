@@ -0,0 +1,156 @@
+// measure the cost of converting native TSC durations to standard durations, directly to each
+// period and with each rounding, compared to converting them to nanoseconds first, and check the
+// results against an exact conversion
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/duration_rounding.h"
+#include "interface/native/native.h"
+
+#if defined(CHRONO_HAVE_TSC)
+
+typedef native::native_duration<int64_t, tsc_tick> native_ticks;
+
+// exact conversion, with the same ratio used by tsc_tick
+template <typename _Period>
+static int64_t exact(int64_t ticks, duration_rounding mode) {
+  __int128_t numerator   = (__int128_t) ticks * (int64_t) tsc_tick::get_cyc2ns().nanoseconds_per_tick_shifted * _Period::den;
+  __int128_t denominator = ((__int128_t) _Period::num * 1000000000) << 32;
+  return (int64_t) rounded_divide<__int128_t>(numerator, denominator, mode);
+}
+
+// time a conversion over all the values, and return the average time per call in nanoseconds
+template <typename Rep, typename F>
+static double measure(F convert, std::vector<int64_t> const & values, std::vector<Rep> & results) {
+  double best = 1.e9;
+  for (int repeat = 0; repeat < 10; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < values.size(); ++i)
+      results[i] = convert(values[i]);
+    auto stop  = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count() / values.size());
+  }
+  return best;
+}
+
+// the results must be within one unit of the exact conversion; for floating point durations the
+// rounding does not apply, and the conversion uses the frequency rather than the 32.32 fixed point
+// ratio, so they are compared with the truncated value, allowing for the precision of the ratio
+template <typename Rep, typename _Period>
+static void check(const char * name, std::vector<int64_t> const & values, std::vector<Rep> const & results, duration_rounding mode) {
+  double max_difference = 0.;
+  for (size_t i = 0; i < values.size(); ++i) {
+    double expected = (double) exact<_Period>(values[i], mode);
+    double tolerance = std::chrono::treat_as_floating_point<Rep>::value ? std::fabs(expected) * 1.e-8 : 0.;
+    max_difference = std::max(max_difference, std::fabs((double) results[i] - expected) - tolerance);
+  }
+  if (max_difference > 1.) {
+    std::cerr << "error: " << name << " differs from the exact conversion by " << max_difference << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+template <typename Rep, typename _Period>
+static void row(const char * period_name, const char * rep_name, std::vector<int64_t> const & values) {
+  typedef std::chrono::duration<Rep, _Period> target;
+  std::vector<Rep> results(values.size());
+
+  double cast  = measure([](int64_t t) { return std::chrono::duration_cast<target>(native_ticks(t)).count(); }, values, results);
+  check<Rep, _Period>("duration_cast", values, results, duration_rounding::toward_zero);
+  double floor = measure([](int64_t t) { return std::chrono::floor<target>(native_ticks(t)).count(); }, values, results);
+  check<Rep, _Period>("floor", values, results, std::chrono::treat_as_floating_point<Rep>::value ? duration_rounding::toward_zero : duration_rounding::floor);
+  double ceil  = measure([](int64_t t) { return std::chrono::ceil<target>(native_ticks(t)).count(); }, values, results);
+  check<Rep, _Period>("ceil", values, results, std::chrono::treat_as_floating_point<Rep>::value ? duration_rounding::toward_zero : duration_rounding::ceil);
+  double round = measure([](int64_t t) { return std::chrono::round<target>(native_ticks(t)).count(); }, values, results);
+  check<Rep, _Period>("round", values, results, std::chrono::treat_as_floating_point<Rep>::value ? duration_rounding::toward_zero : duration_rounding::nearest);
+
+  // the previous implementation, converting to nanoseconds and then to the target period
+  double via_nanoseconds = measure([](int64_t t) {
+      return std::chrono::duration_cast<target>(std::chrono::nanoseconds(tsc_tick::to_nanoseconds(t))).count(); }, values, results);
+
+  std::cout << std::left << std::setw(8) << period_name << std::setw(8) << rep_name << std::right
+            << std::setw(10) << cast << " ns" << std::setw(10) << floor << " ns" << std::setw(10) << ceil << " ns"
+            << std::setw(10) << round << " ns" << std::setw(10) << via_nanoseconds << " ns" << std::endl;
+}
+
+// a counter with exactly two ticks per nanosecond, so that the conversions hit the ties exactly
+struct half_nanosecond_counter {
+  static cyc2ns_data get_cyc2ns() noexcept      { return { 1ull << 31, UINT64_MAX >> 31, 0, 0, 0 }; }
+  static ns2cyc_data get_ns2cyc() noexcept      { return { 2ull << 32, UINT64_MAX >> 33 }; }
+  static double      ticks_per_second() noexcept { return 2.e9; }
+  static double      seconds_per_tick() noexcept { return 0.5e-9; }
+  static uint32_t    generation() noexcept       { return 1; }
+  static int64_t     to_timestamp_far(int64_t ticks) noexcept { return ticks / 2; }
+};
+
+// round() must send the ties to the even value, like std::chrono::round
+template <typename _Period>
+static void check_ties(int64_t ticks_per_unit) {
+  typedef native::native_duration<int64_t, runtime_tick<half_nanosecond_counter>> half_ticks;
+  typedef std::chrono::duration<int64_t, _Period> target;
+  for (int64_t units = -4; units <= 4; ++units) {
+    int64_t ticks    = units * ticks_per_unit + ticks_per_unit / 2;
+    int64_t expected = (units & 1) == 0 ? units : units + 1;
+    int64_t result   = std::chrono::round<target>(half_ticks(ticks)).count();
+    if (result != expected) {
+      std::cerr << "error: round(" << ticks << " ticks) is " << result << " instead of " << expected << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+}
+
+template <typename _Period>
+static void rows(const char * period_name, std::vector<int64_t> const & values) {
+  row<int32_t, _Period>(period_name, "int32",  values);
+  row<int64_t, _Period>(period_name, "int64",  values);
+  row<double,  _Period>(period_name, "double", values);
+}
+
+int main(void) {
+  const size_t size = 1 << 20;
+  std::mt19937_64 random(42);
+
+  tsc_tick::calibrate();
+  double tps = tsc_tick::ticks_per_second();
+
+  // positive and negative intervals up to 1 second, so that the nanoseconds fit in an int32
+  std::vector<int64_t> ticks(size);
+  std::uniform_int_distribution<int64_t> interval(- (int64_t) tps, (int64_t) tps);
+  for (auto & t: ticks)
+    t = interval(random);
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::left << std::setw(8) << "target" << std::setw(8) << "rep" << std::right
+            << std::setw(13) << "cast" << std::setw(13) << "floor" << std::setw(13) << "ceil"
+            << std::setw(13) << "round" << std::setw(13) << "via ns" << std::endl;
+  rows<std::nano>       ("ns", ticks);
+  rows<std::micro>      ("us", ticks);
+  rows<std::milli>      ("ms", ticks);
+  rows<std::ratio<1>>   ("s",  ticks);
+
+  check_ties<std::nano>  (2);
+  check_ties<std::micro> (2000);
+  check_ties<std::milli> (2000000);
+
+  return 0;
+}
+
+#else
+
+int main(void) {
+  std::cout << "TSC not available" << std::endl;
+  return 0;
+}
+
+#endif // defined(CHRONO_HAVE_TSC)
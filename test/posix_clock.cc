@@ -0,0 +1,176 @@
+// compare the clocks based on the posix_clock and syscall_clock templates with hand-written code
+// using the same clock id, and measure the clocks with a clock id only known at run time
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "interface/posix_clock_gettime.h"
+#include "interface/syscall_clock_gettime.h"
+
+#ifdef HAVE_POSIX_CLOCK_REALTIME
+
+// the results are accumulated here, so that the calls cannot be optimised away
+static volatile int64_t sink;
+
+// best average time per call over a few repetitions, in nanoseconds
+template <typename F>
+static double measure(F f, size_t calls) {
+  double best = 1.e9;
+  int64_t sum = 0;
+  for (int repeat = 0; repeat < 10; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; ++i)
+      sum += f();
+    auto stop  = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count() / calls);
+  }
+  sink = sum;
+  return best;
+}
+
+template <typename Clock, typename F>
+static void compare(const char * name, F handwritten, size_t calls) {
+  if (Clock::available() != Clock::is_available) {
+    std::cerr << "error: " << name << ": available() differs from is_available" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  if (!Clock::is_available) {
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(13) << "n/a" << std::setw(13) << "n/a" << std::endl;
+    return;
+  }
+  double time_template    = measure([] { return (int64_t) Clock::now().time_since_epoch().count(); }, calls);
+  double time_handwritten = measure(handwritten, calls);
+  std::cout << std::left << std::setw(48) << name << std::right
+            << std::setw(10) << time_template << " ns" << std::setw(10) << time_handwritten << " ns" << std::endl;
+}
+
+// the previous implementation of the clocks, with the clock id written in the code
+#define HANDWRITTEN_CLOCK_GETTIME(ID) \
+  [] { timespec t; clock_gettime(ID, &t); return (int64_t) (std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec)).count(); }
+
+#define HANDWRITTEN_SYSCALL(ID) \
+  [] { timespec t; syscall(SYS_clock_gettime, ID, &t); return (int64_t) (std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec)).count(); }
+
+// the clocks known to be available at compile time are constants
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC_COARSE
+static_assert(clock_gettime_monotonic_coarse::is_available, "CLOCK_MONOTONIC_COARSE should always be available");
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_MONOTONIC
+static_assert(clock_syscall_monotonic::is_available, "CLOCK_MONOTONIC should always be available through the system call");
+#endif
+
+int main(void) {
+  const size_t calls         = 1 << 20;
+  const size_t syscall_calls = 1 << 16;
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::left << std::setw(48) << "clock" << std::right
+            << std::setw(13) << "template" << std::setw(13) << "hand-written" << std::endl;
+
+  compare<clock_gettime_realtime>("clock_gettime(CLOCK_REALTIME)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_REALTIME), calls);
+#ifdef HAVE_POSIX_CLOCK_REALTIME_COARSE
+  compare<clock_gettime_realtime_coarse>("clock_gettime(CLOCK_REALTIME_COARSE)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_REALTIME_COARSE), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_REALTIME_ALARM
+  compare<clock_gettime_realtime_alarm>("clock_gettime(CLOCK_REALTIME_ALARM)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_REALTIME_ALARM), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_TAI
+  compare<clock_gettime_tai>("clock_gettime(CLOCK_TAI)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_TAI), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC
+  compare<clock_gettime_monotonic>("clock_gettime(CLOCK_MONOTONIC)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_MONOTONIC), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC_COARSE
+  compare<clock_gettime_monotonic_coarse>("clock_gettime(CLOCK_MONOTONIC_COARSE)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_MONOTONIC_COARSE), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC_RAW
+  compare<clock_gettime_monotonic_raw>("clock_gettime(CLOCK_MONOTONIC_RAW)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_MONOTONIC_RAW), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_BOOTTIME
+  compare<clock_gettime_boottime>("clock_gettime(CLOCK_BOOTTIME)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_BOOTTIME), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_BOOTTIME_ALARM
+  compare<clock_gettime_boottime_alarm>("clock_gettime(CLOCK_BOOTTIME_ALARM)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_BOOTTIME_ALARM), calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
+  compare<clock_gettime_process_cputime>("clock_gettime(CLOCK_PROCESS_CPUTIME_ID)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_PROCESS_CPUTIME_ID), syscall_calls);
+#endif
+#ifdef HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+  compare<clock_gettime_thread_cputime>("clock_gettime(CLOCK_THREAD_CPUTIME_ID)", HANDWRITTEN_CLOCK_GETTIME(CLOCK_THREAD_CPUTIME_ID), syscall_calls);
+#endif
+
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME
+  compare<clock_syscall_realtime>("syscall(SYS_clock_gettime, CLOCK_REALTIME)", HANDWRITTEN_SYSCALL(CLOCK_REALTIME), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME_COARSE
+  compare<clock_syscall_realtime_coarse>("syscall(SYS_clock_gettime, CLOCK_REALTIME_COARSE)", HANDWRITTEN_SYSCALL(CLOCK_REALTIME_COARSE), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_REALTIME_ALARM
+  compare<clock_syscall_realtime_alarm>("syscall(SYS_clock_gettime, CLOCK_REALTIME_ALARM)", HANDWRITTEN_SYSCALL(CLOCK_REALTIME_ALARM), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_TAI
+  compare<clock_syscall_tai>("syscall(SYS_clock_gettime, CLOCK_TAI)", HANDWRITTEN_SYSCALL(CLOCK_TAI), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_MONOTONIC
+  compare<clock_syscall_monotonic>("syscall(SYS_clock_gettime, CLOCK_MONOTONIC)", HANDWRITTEN_SYSCALL(CLOCK_MONOTONIC), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_MONOTONIC_COARSE
+  compare<clock_syscall_monotonic_coarse>("syscall(SYS_clock_gettime, CLOCK_MONOTONIC_COARSE)", HANDWRITTEN_SYSCALL(CLOCK_MONOTONIC_COARSE), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_MONOTONIC_RAW
+  compare<clock_syscall_monotonic_raw>("syscall(SYS_clock_gettime, CLOCK_MONOTONIC_RAW)", HANDWRITTEN_SYSCALL(CLOCK_MONOTONIC_RAW), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_BOOTTIME
+  compare<clock_syscall_boottime>("syscall(SYS_clock_gettime, CLOCK_BOOTTIME)", HANDWRITTEN_SYSCALL(CLOCK_BOOTTIME), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_BOOTTIME_ALARM
+  compare<clock_syscall_boottime_alarm>("syscall(SYS_clock_gettime, CLOCK_BOOTTIME_ALARM)", HANDWRITTEN_SYSCALL(CLOCK_BOOTTIME_ALARM), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_PROCESS_CPUTIME_ID
+  compare<clock_syscall_process_cputime>("syscall(SYS_clock_gettime, CLOCK_PROCESS_CPUTIME_ID)", HANDWRITTEN_SYSCALL(CLOCK_PROCESS_CPUTIME_ID), syscall_calls);
+#endif
+#ifdef HAVE_SYSCALL_CLOCK_THREAD_CPUTIME_ID
+  compare<clock_syscall_thread_cputime>("syscall(SYS_clock_gettime, CLOCK_THREAD_CPUTIME_ID)", HANDWRITTEN_SYSCALL(CLOCK_THREAD_CPUTIME_ID), syscall_calls);
+#endif
+  std::cout << std::endl;
+
+  // clocks with an id only known at run time, compared with the clocks with the same meaning
+  std::cout << std::left << std::setw(48) << "clock" << std::right
+            << std::setw(13) << "dynamic" << std::setw(13) << "template" << std::endl;
+#ifdef HAVE_POSIX_CLOCK_THREAD_CPUTIME_ID
+  static const dynamic_posix_clock thread_clock = dynamic_posix_clock::thread_cputime(pthread_self());
+  if (thread_clock.is_available())
+    std::cout << std::left << std::setw(48) << "pthread_getcpuclockid(pthread_self())" << std::right
+              << std::setw(10) << measure([] { return (int64_t) thread_clock.now().time_since_epoch().count(); }, syscall_calls) << " ns"
+              << std::setw(10) << measure([] { return (int64_t) clock_gettime_thread_cputime::now().time_since_epoch().count(); }, syscall_calls) << " ns" << std::endl;
+#endif
+#ifdef HAVE_POSIX_CLOCK_PROCESS_CPUTIME_ID
+  static const dynamic_posix_clock process_clock = dynamic_posix_clock::process_cputime(getpid());
+  if (process_clock.is_available())
+    std::cout << std::left << std::setw(48) << "clock_getcpuclockid(getpid())" << std::right
+              << std::setw(10) << measure([] { return (int64_t) process_clock.now().time_since_epoch().count(); }, syscall_calls) << " ns"
+              << std::setw(10) << measure([] { return (int64_t) clock_gettime_process_cputime::now().time_since_epoch().count(); }, syscall_calls) << " ns" << std::endl;
+#endif
+#ifdef HAVE_POSIX_CLOCK_MONOTONIC
+  static const dynamic_posix_clock monotonic_clock = dynamic_posix_clock(CLOCK_MONOTONIC);
+  std::cout << std::left << std::setw(48) << "CLOCK_MONOTONIC" << std::right
+            << std::setw(10) << measure([] { return (int64_t) monotonic_clock.now().time_since_epoch().count(); }, calls) << " ns"
+            << std::setw(10) << measure([] { return (int64_t) clock_gettime_monotonic::now().time_since_epoch().count(); }, calls) << " ns" << std::endl;
+#endif
+
+  return 0;
+}
+
+#else
+
+int main(void) {
+  std::cout << "clock_gettime() not available" << std::endl;
+  return 0;
+}
+
+#endif // HAVE_POSIX_CLOCK_REALTIME
@@ -0,0 +1,71 @@
+// measure the fixed cost paid by a program linking the chrono library before and after main(),
+// and the cost of the (lazy) calibration of the TSC on first use
+
+// C++ headers
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+// POSIX headers
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_clock.h"
+#include "interface/native/x86_tsc_clock.h"
+
+#ifndef _WIN32
+// CPU time (user + system) used by the process so far, in seconds
+static double process_cputime() {
+  rusage ru;
+  getrusage(RUSAGE_SELF, & ru);
+  return (double) (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + (double) (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1.e-6;
+}
+#endif
+
+template <typename F>
+static double time_call(F && f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+}
+
+int main(void) {
+#ifndef _WIN32
+  // this must be the first thing done in main()
+  double before_main = process_cputime();
+#endif
+
+#if defined(CHRONO_HAVE_TSC)
+  std::cout << std::setprecision(3) << std::fixed;
+#ifndef _WIN32
+  std::cout << "CPU time used before main():           " << std::setw(12) << before_main * 1e3 << " ms" << std::endl;
+#endif
+
+  // reading the TSC through a native clock does not require any calibration
+  double native_now = time_call([] { native::clock_rdtsc::now(); });
+  std::cout << "first native::clock_rdtsc::now():      " << std::setw(12) << native_now * 1e6 << " us" << std::endl;
+
+  // the first conversion triggers the calibration of the TSC
+  double first_now  = time_call([] { clock_rdtsc::now(); });
+  std::cout << "first clock_rdtsc::now() (calibrates): " << std::setw(12) << first_now * 1e3 << " ms" << std::endl;
+
+  double second_now = time_call([] { clock_rdtsc::now(); });
+  std::cout << "second clock_rdtsc::now():             " << std::setw(12) << second_now * 1e6 << " us" << std::endl;
+
+  // further explicit calibrations are no-ops
+  double calibrate  = time_call([] { tsc_tick::calibrate(); });
+  std::cout << "tsc_tick::calibrate() (already done):  " << std::setw(12) << calibrate * 1e6 << " us" << std::endl;
+
+  std::cout << "TSC frequency:                         " << std::setw(12) << tsc_tick::ticks_per_second() / 1.e6 << " MHz"
+            << " (" << tsc_frequency_source_name(tsc_tick::frequency_source()) << ", estimated error " << tsc_tick::estimated_error() << " ppm)" << std::endl;
+#else
+  std::cout << "TSC not available" << std::endl;
+#endif // defined(CHRONO_HAVE_TSC)
+
+  return 0;
+}
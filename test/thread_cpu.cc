@@ -0,0 +1,140 @@
+// measure the cost of sampling the cpu time of a pool of threads with thread_cpu_sampler, as the
+// number of threads grows, and show the utilisation it reports for threads with different loads
+//
+// usage: chrono_thread_cpu [max_threads]
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "interface/thread_cpu_clock.h"
+
+#ifdef HAVE_THREAD_CPU_CLOCK
+
+// a pool of threads that wait until they are released; each one is busy for the given fraction of
+// every millisecond, and sleeps for the rest of it. The threads are removed from the sampler before
+// they are joined, as their clocks are not valid after that.
+class worker_pool {
+public:
+  worker_pool(thread_cpu_sampler & sampler, std::vector<double> const & loads) :
+    sampler_(sampler)
+  {
+    for (double load: loads) {
+      threads_.emplace_back(& worker_pool::work, this, load);
+      indices_.push_back(sampler.add(threads_.back().native_handle()));
+    }
+  }
+
+  ~worker_pool()
+  {
+    for (size_t index: indices_)
+      sampler_.remove(index);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto & thread: threads_)
+      thread.join();
+  }
+
+private:
+  void work(double load)
+  {
+    const auto period = std::chrono::milliseconds(1);
+    const auto busy   = std::chrono::duration_cast<std::chrono::nanoseconds>(period * load);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (load <= 0.) {
+      wakeup_.wait(lock, [this] { return stop_; });
+      return;
+    }
+    auto next = std::chrono::steady_clock::now();
+    while (! stop_) {
+      lock.unlock();
+      auto start = std::chrono::steady_clock::now();
+      while (std::chrono::steady_clock::now() - start < busy)
+        ;
+      lock.lock();
+      next = std::max(next + period, std::chrono::steady_clock::now());
+      wakeup_.wait_until(lock, next, [this] { return stop_; });
+    }
+  }
+
+  thread_cpu_sampler &     sampler_;
+  std::vector<size_t>      indices_;
+  std::mutex               mutex_;
+  std::condition_variable  wakeup_;
+  std::vector<std::thread> threads_;
+  bool                     stop_ = false;
+};
+
+int main(int argc, char ** argv)
+{
+  size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 1024;
+  const unsigned samples = 1000;
+
+  // cost of a sample as the number of idle threads grows
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << std::right << std::setw(8) << "threads" << std::setw(16) << "per sample" << std::setw(16) << "per thread" << std::endl;
+  for (size_t n = 1; n <= max_threads; n *= 2) {
+    thread_cpu_sampler sampler;
+    worker_pool pool(sampler, std::vector<double>(n, 0.));
+
+    thread_cpu_sampler::snapshot snapshot;
+    sampler.sample(snapshot);
+    double best = 1.e12;
+    for (unsigned i = 0; i < samples; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      sampler.sample(snapshot);
+      auto stop  = std::chrono::steady_clock::now();
+      best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count());
+    }
+    std::cout << std::setw(8) << n << std::setw(13) << best << " ns" << std::setw(13) << best / n << " ns" << std::endl;
+  }
+  std::cout << std::endl;
+
+  // utilisation of threads with different loads, over 200 ms
+  std::vector<double> loads = { 0., 0.05, 0.10, 0.20, 0.40 };
+  thread_cpu_sampler sampler;
+  {
+    worker_pool pool(sampler, loads);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto first = sampler.sample();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto second = sampler.sample();
+
+    std::vector<double> utilization = thread_cpu_sampler::utilization(first, second);
+
+    // a removed thread is no longer read, and the other threads keep their index
+    sampler.remove(0);
+    auto third = sampler.sample();
+    if (third.cpu_time[0] != -1 || third.cpu_time[1] < second.cpu_time[1]) {
+      std::cerr << "error: the sampler still reads a removed thread" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << std::right << std::setw(8) << "thread" << std::setw(16) << "load" << std::setw(16) << "utilization" << std::endl;
+    for (size_t i = 0; i < loads.size(); ++i)
+      std::cout << std::setw(8) << i << std::setw(14) << loads[i] * 100. << " %" << std::setw(14) << utilization[i] * 100. << " %" << std::endl;
+  }
+
+  return 0;
+}
+
+#else
+
+int main(void)
+{
+  std::cout << "pthread_getcpuclockid() not available" << std::endl;
+  return 0;
+}
+
+#endif // HAVE_THREAD_CPU_CLOCK
@@ -0,0 +1,151 @@
+// compare the times() clocks, that read their conversion constants from times_scale, with the
+// previous implementations that kept them in function-local statics, checked by a guard on every call
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if !defined(_WIN32)
+
+// POSIX standard headers
+#include <sys/times.h>
+#include <unistd.h>
+
+#include "interface/posix_times.h"
+#include "interface/posix_times_f.h"
+#include "interface/posix_times_d.h"
+
+// read the cpu time or the wall-clock time with times()
+static clock_t cputime() {
+  tms t;
+  times(& t);
+  return t.tms_utime + t.tms_stime;
+}
+
+static clock_t realtime() {
+#ifdef __linux__
+  return times(nullptr);
+#else
+  tms t;
+  return times(& t);
+#endif // __linux__
+}
+
+// previous conversions, with the constants in function-local statics
+static int64_t guarded_to_nanoseconds(clock_t time) {
+  static const long ticks_per_second = sysconf(_SC_CLK_TCK);
+  static const long nanoseconds_per_tick = 1000000000l / ticks_per_second;
+  static const bool accurate = ((1000000000l % ticks_per_second) == 0);
+  return accurate ? time * nanoseconds_per_tick : time * 1000000000l / ticks_per_second;
+}
+
+static int64_t guarded_to_nanoseconds_fixed(clock_t time) {
+  static const long ticks_per_second = sysconf(_SC_CLK_TCK);
+  static const int64_t nanoseconds_per_tick = (1000000000ull << 32) / ticks_per_second;
+  return (int64_t) (((__int128_t) time * nanoseconds_per_tick) >> 32);
+}
+
+static double guarded_to_seconds(clock_t time) {
+  static const double ticks_per_second = sysconf(_SC_CLK_TCK);
+  static const double seconds_per_tick = 1. / ticks_per_second;
+  return (double) time * seconds_per_tick;
+}
+
+// the results are accumulated here, so that the calls cannot be optimised away
+static volatile double sink;
+
+// best average time per call over a few repetitions, in nanoseconds
+template <typename F>
+static double measure(F f, size_t calls, double & sum) {
+  double best = 1.e9;
+  for (int repeat = 0; repeat < 10; ++repeat) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; ++i)
+      sum += (double) f(i);
+    auto stop  = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(stop - start).count() / calls);
+  }
+  return best;
+}
+
+template <typename F, typename G>
+static void compare(const char * name, F current, G guarded, size_t calls) {
+  double sum = 0.;
+  double time_current = measure(current, calls, sum);
+  double time_guarded = measure(guarded, calls, sum);
+  std::cout << std::left << std::setw(48) << name << std::right
+            << std::setw(10) << time_current << " ns" << std::setw(10) << time_guarded << " ns" << std::endl;
+  sink = sum;
+}
+
+int main(void) {
+  const size_t size  = 1 << 20;
+  const size_t calls = 1 << 16;
+
+  // the conversions alone, on values spread over a few days of ticks
+  std::vector<clock_t> values(size);
+  for (size_t i = 0; i < size; ++i)
+    values[i] = (clock_t) (i * 37);
+
+  // the results must not change
+  for (size_t i = 0; i < size; ++i) {
+    if (times_scale.to_nanoseconds(values[i]) != guarded_to_nanoseconds(values[i]) ||
+        times_scale.to_nanoseconds_fixed(values[i]) != guarded_to_nanoseconds_fixed(values[i]) ||
+        times_scale.to_seconds((double) values[i]) != guarded_to_seconds(values[i])) {
+      std::cerr << "error: the conversion of " << values[i] << " ticks differs from the previous implementation" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "times() ticks per second: " << times_scale.ticks_per_second << (times_scale.exact ? " (exact)" : "") << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << std::left << std::setw(48) << "conversion" << std::right
+            << std::setw(13) << "times_scale" << std::setw(13) << "guarded" << std::endl;
+  compare("to nanoseconds",
+      [&](size_t i) { return times_scale.to_nanoseconds(values[i % size]); },
+      [&](size_t i) { return guarded_to_nanoseconds(values[i % size]); }, size);
+  compare("to nanoseconds (using fixed math)",
+      [&](size_t i) { return times_scale.to_nanoseconds_fixed(values[i % size]); },
+      [&](size_t i) { return guarded_to_nanoseconds_fixed(values[i % size]); }, size);
+  compare("to seconds (using double)",
+      [&](size_t i) { return times_scale.to_seconds((double) values[i % size]); },
+      [&](size_t i) { return guarded_to_seconds(values[i % size]); }, size);
+  std::cout << std::endl;
+
+  // the full clocks, including the system call
+  std::cout << std::left << std::setw(48) << "clock" << std::right
+            << std::setw(13) << "times_scale" << std::setw(13) << "guarded" << std::endl;
+  compare("times() (wall-clock time)",
+      [](size_t) { return clock_times_realtime::now().time_since_epoch().count(); },
+      [](size_t) { return guarded_to_nanoseconds(realtime()); }, calls);
+  compare("times() (cpu time)",
+      [](size_t) { return clock_times_cputime::now().time_since_epoch().count(); },
+      [](size_t) { return guarded_to_nanoseconds(cputime()); }, calls);
+  compare("times() (wall-clock time) (using double)",
+      [](size_t) { return clock_times_realtime_d::now().time_since_epoch().count(); },
+      [](size_t) { return guarded_to_seconds(realtime()); }, calls);
+  compare("times() (cpu time) (using double)",
+      [](size_t) { return clock_times_cputime_d::now().time_since_epoch().count(); },
+      [](size_t) { return guarded_to_seconds(cputime()); }, calls);
+  compare("times() (wall-clock time) (using fixed math)",
+      [](size_t) { return clock_times_realtime_f::now().time_since_epoch().count(); },
+      [](size_t) { return guarded_to_nanoseconds_fixed(realtime()); }, calls);
+  compare("times() (cpu time) (using fixed math)",
+      [](size_t) { return clock_times_cputime_f::now().time_since_epoch().count(); },
+      [](size_t) { return guarded_to_nanoseconds_fixed(cputime()); }, calls);
+
+  return 0;
+}
+
+#else
+
+int main(void) {
+  std::cout << "times() not available" << std::endl;
+  return 0;
+}
+
+#endif // !defined(_WIN32)
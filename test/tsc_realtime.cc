@@ -0,0 +1,104 @@
+// check clock_tsc_realtime and native::clock_tsc_realtime against CLOCK_REALTIME over a few resyncs,
+// while the TSC frequency is being refined, and print the largest error of each one; the time
+// points of the native clock are converted with a plain duration_cast of their time since 1970
+//
+// usage: chrono_tsc_realtime [seconds]
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_realtime.h"
+#include "interface/x86_tsc_clock.h"
+#include "interface/native/x86_tsc_clock.h"
+
+#if defined(CHRONO_HAVE_TSC)
+
+static int64_t realtime_nanoseconds()
+{
+  timespec t;
+  clock_gettime(CLOCK_REALTIME, & t);
+  return (int64_t) t.tv_sec * 1000000000ll + t.tv_nsec;
+}
+
+// largest distance of the clock from the bracket of two reads of CLOCK_REALTIME, in nanoseconds;
+// the brackets longer than 10 us (e.g. because of a preemption) are skipped
+template <typename F>
+static int64_t max_error(F now, std::chrono::nanoseconds duration)
+{
+  int64_t worst = 0;
+  int64_t stop  = realtime_nanoseconds() + duration.count();
+  while (true) {
+    int64_t before = realtime_nanoseconds();
+    int64_t value  = now();
+    int64_t after  = realtime_nanoseconds();
+    if (before > stop)
+      break;
+    if (after - before < 10000)
+      worst = std::max(worst, std::max(before - value, value - after));
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  return worst;
+}
+
+int main(int argc, char ** argv)
+{
+  if (! clock_tsc_realtime::is_available) {
+    std::cout << "TSC not available" << std::endl;
+    return 0;
+  }
+
+  auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(argc > 1 ? std::strtod(argv[1], nullptr) : 1.));
+
+  // the first anchor fixes the scale of the native clock; a time point taken now must convert to
+  // the same time after the refinements of the frequency
+  tsc_tick::calibrate();
+  double frequency_ppm = tsc_tick::estimated_error();
+  auto   first         = native::clock_tsc_realtime::now();
+  auto   first_ns      = std::chrono::duration_cast<std::chrono::nanoseconds>(first.time_since_epoch());
+  bool   refining      = tsc_tick::start_refinement(std::chrono::milliseconds(10));
+
+  // the drift allowed between two resyncs, by the NTP slew rate and the error of the frequency (100 ppm
+  // if it is unknown), plus 1 us for the measurement of the offset
+  double interval = (double) tsc_realtime::get_resync_interval().count();
+  double bound    = interval * (500. + (std::isnan(frequency_ppm) ? 100. : frequency_ppm)) * 1.e-6 + 1000.;
+
+  int64_t error = max_error([] { return clock_tsc_realtime::now().time_since_epoch().count(); }, duration);
+  int64_t native_error = max_error([] {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(native::clock_tsc_realtime::now().time_since_epoch()).count(); }, duration);
+  int64_t moved = (std::chrono::duration_cast<std::chrono::nanoseconds>(first.time_since_epoch()) - first_ns).count();
+  if (refining)
+    tsc_tick::stop_refinement();
+
+  std::cout << "TSC frequency " << std::fixed << std::setprecision(3) << tsc_tick::ticks_per_second() / 1.e6 << " MHz, "
+            << (refining ? "refined" : "not refined") << " during the test" << std::endl;
+  std::cout << std::setprecision(1);
+  std::cout << "allowed error:                 " << std::setw(10) << bound << " ns" << std::endl;
+  std::cout << "clock_tsc_realtime:            " << std::setw(10) << (double) error << " ns" << std::endl;
+  std::cout << "native::clock_tsc_realtime:    " << std::setw(10) << (double) native_error << " ns" << std::endl;
+  std::cout << "first native time point moved: " << std::setw(10) << (double) moved << " ns" << std::endl;
+
+  if (error > bound || native_error > bound || moved != 0) {
+    std::cout << "FAIL" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "PASS" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+#else
+
+int main(void)
+{
+  std::cout << "TSC not available" << std::endl;
+  return 0;
+}
+
+#endif // defined(CHRONO_HAVE_TSC)
@@ -0,0 +1,119 @@
+// check that the TSCs of all the CPUs the process can run on are synchronized, printing the
+// bounds on the offset of each pair of CPUs and a pass/fail verdict; before that, check that the
+// CPU and node returned by clock_rdtscp_cpu and clock_rdpid_cpu next to their time points match
+// those reported by the kernel, with the thread pinned to each CPU in turn
+//
+// usage: chrono_tsc_sync [rounds [tolerance_ns]]
+
+// C++ headers
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <type_traits>
+
+#include "interface/x86_tsc.h"
+#include "interface/x86_tsc_tick.h"
+#include "interface/x86_tsc_sync.h"
+#include "interface/x86_tsc_clock.h"
+
+#ifdef CHRONO_HAVE_TSC_SYNC
+
+// POSIX and Linux headers
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// the CPU is returned separately, so the time points are those of a standard clock
+static_assert(std::is_same<clock_rdtscp_cpu::time_point, std::chrono::time_point<clock_rdtscp_cpu, clock_rdtscp_cpu::duration>>::value,
+    "clock_rdtscp_cpu::time_point must be a std::chrono::time_point");
+
+// compare cpu() and node() with getcpu(), on each CPU the process can run on
+template <typename Clock>
+static bool check_cpu_and_node(const char * name)
+{
+  cpu_set_t allowed;
+  CPU_ZERO(& allowed);
+  if (sched_getaffinity(0, sizeof(allowed), & allowed) != 0)
+    return false;
+
+  bool ok = true;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (! CPU_ISSET(cpu, & allowed))
+      continue;
+    cpu_set_t set;
+    CPU_ZERO(& set);
+    CPU_SET(cpu, & set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), & set) != 0)
+      continue;
+
+    tsc_aux aux;
+    Clock::now(aux);
+    unsigned kernel_cpu, kernel_node;
+    if (syscall(SYS_getcpu, & kernel_cpu, & kernel_node, nullptr) != 0)
+      continue;
+    if (aux.cpu() != kernel_cpu || aux.node() != kernel_node || (int) kernel_cpu != sched_getcpu()) {
+      std::cout << name << " reports cpu " << aux.cpu() << " node " << aux.node()
+                << " on cpu " << kernel_cpu << " node " << kernel_node << std::endl;
+      ok = false;
+    }
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(allowed), & allowed);
+  return ok;
+}
+
+#endif // CHRONO_HAVE_TSC_SYNC
+
+int main(int argc, char ** argv)
+{
+#ifdef CHRONO_HAVE_TSC_SYNC
+  if (! has_rdtscp() || ! tsc_allowed()) {
+    std::cout << "rdtscp is not available" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool cpu_ok = check_cpu_and_node<clock_rdtscp_cpu>("rdtscp");
+#ifdef CHRONO_HAVE_RDPID
+  if (has_rdpid())
+    cpu_ok = check_cpu_and_node<clock_rdpid_cpu>("rdpid") && cpu_ok;
+#endif // CHRONO_HAVE_RDPID
+  std::cout << "CPU and node from TSC_AUX: " << (cpu_ok ? "PASS" : "FAIL") << std::endl;
+
+  unsigned rounds    = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 1000;
+  double   tolerance = argc > 2 ? std::strtod(argv[2], nullptr) : 0.;
+  double   ns        = 1.e9 / tsc_tick::ticks_per_second();
+
+  tsc_sync_report report = check_tsc_sync(rounds, (int64_t) std::ceil(tolerance / ns));
+  size_t n = report.cpus.size();
+
+  std::cout << "TSC offset of each CPU (column) with respect to each other CPU (row), in ns, as the centre and half width of the bounds" << std::endl;
+  std::cout << "    ";
+  for (size_t j = 0; j < n; ++j)
+    std::cout << std::setw(18) << report.cpus[j];
+  std::cout << std::endl;
+  for (size_t i = 0; i < n; ++i) {
+    std::cout << std::setw(4) << report.cpus[i];
+    for (size_t j = 0; j < n; ++j) {
+      tsc_offset_bounds const & bounds = report.offset(i, j);
+      if (bounds.samples == 0) {
+        std::cout << std::setw(18) << "n/a";
+        continue;
+      }
+      double centre = ((double) bounds.lower + (double) bounds.upper) / 2. * ns;
+      double width  = ((double) bounds.upper - (double) bounds.lower) / 2. * ns;
+      std::cout << std::fixed << std::setprecision(1) << std::setw(10) << centre << " +/-" << std::setw(4) << std::setprecision(0) << width;
+    }
+    std::cout << std::endl;
+  }
+
+  if (n < 2)
+    std::cout << "only one CPU available, nothing to compare" << std::endl;
+  std::cout << "TSC synchronization: " << (report.synchronized ? "PASS" : "FAIL") << std::endl;
+  return report.synchronized && cpu_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+  std::cout << "TSC synchronization check not supported on this platform" << std::endl;
+  return EXIT_FAILURE;
+#endif // CHRONO_HAVE_TSC_SYNC
+}